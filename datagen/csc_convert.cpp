@@ -0,0 +1,22 @@
+#include <iostream>
+#include <chrono>
+
+#include "seq_csc_matrix.cpp"
+
+// Converts a SNAP edge list into a binary CSC snapshot, which the test programs can then map instead of parsing.
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        std::cout << "Usage: " << argv[0] << " <graph_file> <snapshot_file>" << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    sequential::CSC_Matrix *M = sequential::load_graph_CSC(argv[1]);
+    sequential::save_graph_CSC(M, argv[2]);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double> elapsed = end - start;
+    std::cout << "Snapshot written to " << argv[2] << " in " << elapsed.count() << " s" << std::endl;
+
+    return 0;
+}
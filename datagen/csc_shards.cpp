@@ -0,0 +1,370 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+
+#include "csc_snapshot.cpp"
+#include "edge_list_parser.cpp"
+
+/**
+ * @namespace shards
+ * @brief Contains the on-disk layout of a graph split by destination range into shards, and the functions to build it
+ * from an edge list or a snapshot without holding the edges in memory.
+ *
+ * Every shard is the transposed matrix (the in-edges) of a contiguous range of rows, as the partitions of
+ * parallel::load_graph_CSC, with the out degrees of its rows. The ranges are chosen so that two shards fit in the
+ * memory budget next to the rank vectors, and a directory holds a meta file, a degree file and one file per shard.
+ */
+namespace shards {
+
+    const char META_MAGIC[8] = {'P', 'R', 'S', 'H', 'M', 'E', 'T', '\0'};
+    const char SHARD_MAGIC[8] = {'P', 'R', 'S', 'H', 'A', 'R', 'D', '\0'};
+
+    // The rank vectors kept in memory by the out-of-core solver: the ranks and two contribution vectors
+    const int RESIDENT_VECTORS = 3;
+
+
+    /**
+     * @struct Shard
+     * @brief The in-edges of a range of rows, loaded in memory.
+     */
+    struct Shard {
+        long first_row = 0, rows = 0, edges = 0;
+        std::vector<long> ROW_PTR;     // len = rows + 1, offsets into COL_INDEX
+        std::vector<long> OUT_DEGREE;  // len = rows
+        std::vector<long> COL_INDEX;   // len = edges, sources of the in-edges
+    };
+
+    /**
+     * @brief Returns the bytes taken in memory by a shard with the given rows and edges.
+     */
+    inline long shard_bytes(long rows, long edges) {
+        return (2 * rows + 1 + edges) * sizeof(long);
+    }
+
+
+    /**
+     * @struct Sharded_Graph
+     * @brief The description of a sharded graph: its size and the rows of every shard.
+     */
+    struct Sharded_Graph {
+        std::string dir;
+        long n, NNZ;
+        std::vector<long> bounds;   // len = num_shards + 1, the first row of every shard
+
+        long num_shards() const {
+            return bounds.size() - 1;
+        }
+
+        std::string meta_path() const { return dir + "/meta.bin"; }
+        std::string degree_path() const { return dir + "/degree.bin"; }
+        std::string shard_path(long k) const { return dir + "/shard_" + std::to_string(k) + ".bin"; }
+    };
+
+
+    // ------------------ Read ------------------
+
+    /**
+     * @brief Opens a sharded graph built by build.
+     *
+     * @param dir The directory of the shards.
+     * @return The description of the graph.
+     */
+    Sharded_Graph open(const std::string &dir) {
+        Sharded_Graph G;
+        G.dir = dir;
+
+        std::ifstream file(G.meta_path(), std::ios::binary);
+        char magic[8];
+        int64_t header[3];
+
+        if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, META_MAGIC, sizeof(magic)) != 0 ||
+            !file.read(reinterpret_cast<char*>(header), sizeof(header))) {
+            std::cout << "Invalid shard directory" << std::endl;
+            exit(1);
+        }
+
+        G.n = header[0];
+        G.NNZ = header[1];
+        G.bounds.resize(header[2] + 1);
+        if (!file.read(reinterpret_cast<char*>(G.bounds.data()), G.bounds.size() * sizeof(long))) {
+            std::cout << "Corrupted shard directory" << std::endl;
+            exit(1);
+        }
+
+        return G;
+    }
+
+
+    /**
+     * @brief Reads a shard into S, reusing its buffers.
+     *
+     * @param G The sharded graph.
+     * @param k The index of the shard.
+     * @param S The shard where the data is read.
+     */
+    void read_shard(const Sharded_Graph &G, long k, Shard &S) {
+        std::ifstream file(G.shard_path(k), std::ios::binary);
+        char magic[8];
+        int64_t header[3];
+
+        if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, SHARD_MAGIC, sizeof(magic)) != 0 ||
+            !file.read(reinterpret_cast<char*>(header), sizeof(header))) {
+            std::cout << "Invalid shard file: " << G.shard_path(k) << std::endl;
+            exit(1);
+        }
+
+        S.first_row = header[0];
+        S.rows = header[1];
+        S.edges = header[2];
+        S.ROW_PTR.resize(S.rows + 1);
+        S.OUT_DEGREE.resize(S.rows);
+        S.COL_INDEX.resize(S.edges);
+
+        file.read(reinterpret_cast<char*>(S.ROW_PTR.data()), S.ROW_PTR.size() * sizeof(long));
+        file.read(reinterpret_cast<char*>(S.OUT_DEGREE.data()), S.OUT_DEGREE.size() * sizeof(long));
+        file.read(reinterpret_cast<char*>(S.COL_INDEX.data()), S.COL_INDEX.size() * sizeof(long));
+
+        if (!file) {
+            std::cout << "Corrupted shard file: " << G.shard_path(k) << std::endl;
+            exit(1);
+        }
+    }
+
+
+    // ------------------ Build ------------------
+
+    /**
+     * @brief Calls f(from, to) for every edge of a text edge list or of a snapshot, without loading it in memory.
+     */
+    template <typename F>
+    void for_each_edge(const char *filename, F f) {
+        if (snapshot::is_snapshot(filename)) {
+            snapshot::Mapped_CSC *S = snapshot::map_graph_CSC(filename);
+            for (long i = 0; i < S->n; i++) {
+                for (long j = S->COL_PTR[i]; j < S->COL_PTR[i + 1]; j++) {
+                    f(i, S->ROW_INDEX[j]);
+                }
+            }
+            delete S;
+            return;
+        }
+
+        edge_list::Mapped_File file(filename);
+        const char *end = file.data + file.size;
+        long n, NNZ;
+        const char *p = edge_list::read_header(file.data, end, n, NNZ);
+
+        long from, to;
+        while (p < end) {
+            if (edge_list::parse_edge(p, end, from, to)) f(from, to);
+        }
+    }
+
+
+    /**
+     * @struct Degree_Count
+     * @brief The size and the degrees of a graph, counted in a pass over its edges.
+     */
+    struct Degree_Count {
+        long n = 0, NNZ = 0;
+        std::vector<long> out_degree, in_degree;  // len = n
+    };
+
+
+    /**
+     * @brief Counts the degrees of a text edge list or of a snapshot, without loading it in memory.
+     *
+     * The number of nodes is the one of the snapshot or of the "# Nodes:" header, as in edge_list::parse_CSC, so the
+     * nodes with the highest ids count even when they have no edges; only without a header is it the largest id
+     * plus one.
+     *
+     * @param filename The text edge list or snapshot of the graph.
+     * @return The size and the degrees of the graph.
+     */
+    Degree_Count count_degrees(const char *filename) {
+        Degree_Count D;
+        long n = -1, NNZ;
+
+        if (snapshot::is_snapshot(filename)) {
+            snapshot::Mapped_CSC *S = snapshot::map_graph_CSC(filename);
+            n = S->n;
+            delete S;
+        } else {
+            edge_list::Mapped_File file(filename);
+            edge_list::read_header(file.data, file.data + file.size, n, NNZ);
+        }
+
+        if (n >= 0) {
+            D.out_degree.assign(n, 0);
+            D.in_degree.assign(n, 0);
+        }
+
+        for_each_edge(filename, [&](long from, long to) {
+            if (from < 0 || to < 0) {
+                std::cout << "Negative node id in edge list" << std::endl;
+                exit(1);
+            }
+
+            long needed = std::max(from, to) + 1;
+            if ((long)D.out_degree.size() < needed) {
+                if (n >= 0) {
+                    std::cout << "Node id " << needed - 1 << " out of range" << std::endl;
+                    exit(1);
+                }
+                D.out_degree.resize(needed, 0);
+                D.in_degree.resize(needed, 0);
+            }
+            D.out_degree[from]++;
+            D.in_degree[to]++;
+            D.NNZ++;
+        });
+
+        D.n = D.out_degree.size();
+        return D;
+    }
+
+
+    /**
+     * @brief Splits a graph into shards by destination range.
+     *
+     * The input is read three times: to count the degrees, to append every edge to a temporary file of its shard,
+     * and, one shard at a time, to build the in-edges of the shard from its temporary file. Apart from the shard being
+     * built, only the degree arrays are held in memory.
+     *
+     * @param filename The text edge list or snapshot of the graph.
+     * @param dir The directory where the shards are written. It must exist.
+     * @param memory_budget The bytes the out-of-core solver may use: the rank vectors plus two shards.
+     * @return The description of the sharded graph.
+     */
+    Sharded_Graph build(const char *filename, const std::string &dir, long memory_budget) {
+        Sharded_Graph G;
+        G.dir = dir;
+
+        // Degrees
+        Degree_Count D = count_degrees(filename);
+        const std::vector<long> &out_degree = D.out_degree, &in_degree = D.in_degree;
+        G.n = D.n;
+        G.NNZ = D.NNZ;
+
+        // Shard bounds: as many rows as fit in half of what the rank vectors leave of the budget
+        long shard_limit = (memory_budget - RESIDENT_VECTORS * G.n * (long)sizeof(double)) / 2;
+        if (shard_limit <= 0) {
+            std::cout << "The memory budget is too small for the rank vectors" << std::endl;
+            exit(1);
+        }
+
+        G.bounds.push_back(0);
+        long rows = 0, edges = 0;
+        for (long r = 0; r < G.n; r++) {
+            if (shard_bytes(rows + 1, edges + in_degree[r]) > shard_limit) {
+                if (rows == 0) {
+                    std::cout << "The memory budget is too small for the in-edges of node " << r << std::endl;
+                    exit(1);
+                }
+                G.bounds.push_back(r);
+                rows = 0;
+                edges = 0;
+            }
+            rows++;
+            edges += in_degree[r];
+        }
+        G.bounds.push_back(G.n);
+
+        // Distribute the edges to the temporary file of their shard
+        long S = G.num_shards();
+        const long buffer_edges = std::max<long>(1024, std::min<long>(1 << 16, shard_limit / (16 * S)));
+        std::vector<std::ofstream> temp(S);
+        std::vector<std::vector<long>> buffer(S);
+        for (long k = 0; k < S; k++) {
+            temp[k].open(dir + "/edges_" + std::to_string(k) + ".tmp", std::ios::binary | std::ios::trunc);
+            if (!temp[k].is_open()) {
+                std::cout << "Unable to open file" << std::endl;
+                exit(1);
+            }
+        }
+
+        auto flush = [&](long k) {
+            temp[k].write(reinterpret_cast<const char*>(buffer[k].data()), buffer[k].size() * sizeof(long));
+            buffer[k].clear();
+        };
+
+        for_each_edge(filename, [&](long from, long to) {
+            long k = std::upper_bound(G.bounds.begin(), G.bounds.end(), to) - G.bounds.begin() - 1;
+            buffer[k].push_back(from);
+            buffer[k].push_back(to);
+            if ((long)buffer[k].size() >= 2 * buffer_edges) flush(k);
+        });
+        for (long k = 0; k < S; k++) {
+            flush(k);
+            temp[k].close();
+        }
+        std::vector<std::vector<long>>().swap(buffer);
+
+        // Build every shard from its temporary file
+        Shard shard;
+        std::vector<long> chunk(2 * buffer_edges), cursor;
+        for (long k = 0; k < S; k++) {
+            shard.first_row = G.bounds[k];
+            shard.rows = G.bounds[k + 1] - G.bounds[k];
+            shard.ROW_PTR.assign(shard.rows + 1, 0);
+            for (long i = 0; i < shard.rows; i++) {
+                shard.ROW_PTR[i + 1] = shard.ROW_PTR[i] + in_degree[shard.first_row + i];
+            }
+            shard.edges = shard.ROW_PTR[shard.rows];
+            shard.OUT_DEGREE.assign(out_degree.begin() + shard.first_row, out_degree.begin() + G.bounds[k + 1]);
+            shard.COL_INDEX.resize(shard.edges);
+            cursor.assign(shard.ROW_PTR.begin(), shard.ROW_PTR.end() - 1);
+
+            std::string temp_path = dir + "/edges_" + std::to_string(k) + ".tmp";
+            std::ifstream in(temp_path, std::ios::binary);
+            while (in.read(reinterpret_cast<char*>(chunk.data()), chunk.size() * sizeof(long)) || in.gcount() > 0) {
+                long count = in.gcount() / sizeof(long);
+                for (long e = 0; e < count; e += 2) {
+                    shard.COL_INDEX[cursor[chunk[e + 1] - shard.first_row]++] = chunk[e];
+                }
+            }
+            in.close();
+            std::remove(temp_path.c_str());
+
+            for (long i = 0; i < shard.rows; i++) {
+                std::sort(shard.COL_INDEX.begin() + shard.ROW_PTR[i], shard.COL_INDEX.begin() + shard.ROW_PTR[i + 1]);
+            }
+
+            std::ofstream out(G.shard_path(k), std::ios::binary | std::ios::trunc);
+            int64_t header[3] = {shard.first_row, shard.rows, shard.edges};
+            out.write(SHARD_MAGIC, sizeof(SHARD_MAGIC));
+            out.write(reinterpret_cast<const char*>(header), sizeof(header));
+            out.write(reinterpret_cast<const char*>(shard.ROW_PTR.data()), shard.ROW_PTR.size() * sizeof(long));
+            out.write(reinterpret_cast<const char*>(shard.OUT_DEGREE.data()), shard.OUT_DEGREE.size() * sizeof(long));
+            out.write(reinterpret_cast<const char*>(shard.COL_INDEX.data()), shard.COL_INDEX.size() * sizeof(long));
+            if (!out) {
+                std::cout << "Error while writing the shards" << std::endl;
+                exit(1);
+            }
+        }
+
+        // Degrees and meta file
+        std::ofstream degree(G.degree_path(), std::ios::binary | std::ios::trunc);
+        degree.write(reinterpret_cast<const char*>(out_degree.data()), out_degree.size() * sizeof(long));
+
+        std::ofstream meta(G.meta_path(), std::ios::binary | std::ios::trunc);
+        int64_t header[3] = {G.n, G.NNZ, S};
+        meta.write(META_MAGIC, sizeof(META_MAGIC));
+        meta.write(reinterpret_cast<const char*>(header), sizeof(header));
+        meta.write(reinterpret_cast<const char*>(G.bounds.data()), G.bounds.size() * sizeof(long));
+
+        if (!degree || !meta) {
+            std::cout << "Error while writing the shards" << std::endl;
+            exit(1);
+        }
+
+        return G;
+    }
+}
@@ -0,0 +1,335 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @namespace snapshot
+ * @brief Contains the on-disk binary layout of a CSC matrix and the functions to write it and map it back into memory.
+ *
+ * The file is made of a fixed size header followed by the four arrays of the matrix (COL_PTR, ROW_INDEX, OUT_DEGREE
+ * and indexes_null_cols), each stored as 64-bit integers and aligned to a 64-byte boundary, so that once the file is
+ * mapped the arrays can be used in place without any parsing or copying.
+ */
+namespace snapshot {
+
+    static_assert(sizeof(long) == sizeof(int64_t), "The snapshot format requires 64-bit long");
+
+    const char MAGIC[8] = {'P', 'R', 'C', 'S', 'C', '\0', '\0', '\0'};
+    const uint32_t VERSION = 1;
+    const uint32_t ENDIAN_CHECK = 0x01020304;
+    const int64_t ALIGNMENT = 64;
+
+
+    // ------------------ File header ------------------
+
+    /**
+     * @struct Header
+     * @brief The header at the beginning of a snapshot file. Offsets are in bytes from the beginning of the file.
+     */
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t byte_order;
+        int64_t n, NNZ, num_null_cols;
+        int64_t col_ptr_offset;
+        int64_t row_index_offset;
+        int64_t out_degree_offset;
+        int64_t null_cols_offset;
+        int64_t file_size;
+    };
+
+
+    /**
+     * @brief Rounds the given offset up to the next multiple of ALIGNMENT.
+     */
+    inline int64_t align(int64_t offset) {
+        return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+
+    /**
+     * @brief Fills the header for a matrix of the given size, computing the offset of each array.
+     *
+     * @param n The number of nodes in the graph.
+     * @param NNZ The number of non-zero elements in the graph.
+     * @param num_null_cols The number of null columns.
+     * @return The filled header.
+     */
+    inline Header make_header(long n, long NNZ, long num_null_cols) {
+        Header h;
+        std::memset(&h, 0, sizeof(h));
+        std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+        h.version = VERSION;
+        h.byte_order = ENDIAN_CHECK;
+        h.n = n;
+        h.NNZ = NNZ;
+        h.num_null_cols = num_null_cols;
+
+        h.col_ptr_offset = align(sizeof(Header));
+        h.row_index_offset = align(h.col_ptr_offset + (n + 1) * sizeof(int64_t));
+        h.out_degree_offset = align(h.row_index_offset + NNZ * sizeof(int64_t));
+        h.null_cols_offset = align(h.out_degree_offset + n * sizeof(int64_t));
+        h.file_size = h.null_cols_offset + num_null_cols * sizeof(int64_t);
+
+        return h;
+    }
+
+
+    // ------------------ Write ------------------
+
+    /**
+     * @brief Writes the arrays of a CSC matrix to a snapshot file.
+     *
+     * @param filename The name of the output file.
+     * @param n The number of nodes in the graph.
+     * @param NNZ The number of non-zero elements in the graph.
+     * @param num_null_cols The number of null columns.
+     * @param COL_PTR The column pointer array (len = n + 1).
+     * @param ROW_INDEX The row index array (len = NNZ).
+     * @param OUT_DEGREE The out degree array (len = n).
+     * @param indexes_null_cols The indexes of the null columns (len = num_null_cols).
+     */
+    void write(const char *filename, long n, long NNZ, long num_null_cols,
+               const long *COL_PTR, const long *ROW_INDEX, const long *OUT_DEGREE, const long *indexes_null_cols) {
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+
+        if (!file.is_open()) {
+            std::cout << "Unable to open file" << std::endl;
+            exit(1);
+        }
+
+        Header h = make_header(n, NNZ, num_null_cols);
+        const char padding[ALIGNMENT] = {0};
+
+        auto write_array = [&](int64_t offset, const long *data, long len) {
+            file.write(padding, offset - file.tellp());
+            file.write(reinterpret_cast<const char*>(data), len * sizeof(int64_t));
+        };
+
+        file.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        write_array(h.col_ptr_offset, COL_PTR, n + 1);
+        write_array(h.row_index_offset, ROW_INDEX, NNZ);
+        write_array(h.out_degree_offset, OUT_DEGREE, n);
+        write_array(h.null_cols_offset, indexes_null_cols, num_null_cols);
+
+        if (!file) {
+            std::cout << "Error while writing the snapshot" << std::endl;
+            exit(1);
+        }
+    }
+
+
+    // ------------------ Mapped matrix ------------------
+
+    /**
+     * @struct Mapped_CSC
+     * @brief A read-only CSC matrix whose arrays point directly into a memory-mapped snapshot file.
+     *
+     * It exposes the same fields as the in-memory CSC_Matrix, so the Page Rank functions can be used on it unchanged.
+     */
+    struct Mapped_CSC {
+        long n, NNZ, num_null_cols;
+        const long *ROW_INDEX;         // len = NNZ
+        const long *COL_PTR;           // len = n + 1
+        const long *OUT_DEGREE;        // len = n
+        const long *indexes_null_cols; // len = num_null_cols
+
+        void *base = nullptr;
+        size_t size = 0;
+
+
+        Mapped_CSC() = default;
+        Mapped_CSC(const Mapped_CSC&) = delete;
+        Mapped_CSC& operator=(const Mapped_CSC&) = delete;
+
+        ~Mapped_CSC() {
+            if (base != nullptr) {
+                munmap(base, size);
+            }
+        }
+
+
+        /**
+         * @brief Prints all the matrix information.
+         *
+         * @param max_el The maximum number of elements to print. Defaults to 15.
+         */
+        void print_info(int max_el = 15) {
+            std::cout << "Nodes: " << n << std::endl;
+            std::cout << "Edges: " << NNZ << std::endl;
+
+            auto print_array = [&](const char *name, const long *data, long len) {
+                std::cout << name;
+                for (long i = 0; i < std::min<long>(max_el, len); i++) {
+                    std::cout << data[i] << " ";
+                }
+                std::cout << std::endl;
+            };
+
+            print_array("Row index: ", ROW_INDEX, NNZ);
+            print_array("Column pointer: ", COL_PTR, n + 1);
+            print_array("Out degree: ", OUT_DEGREE, n);
+            std::cout << "Null columns: " << num_null_cols << std::endl;
+            print_array("Null columns indexes: ", indexes_null_cols, num_null_cols);
+            std::cout << std::endl;
+        }
+    };
+
+
+    // ------------------ Read ------------------
+
+    /**
+     * @brief Checks whether the given file starts with the snapshot magic bytes.
+     *
+     * @param filename The name of the file.
+     * @return true if the file is a snapshot, false otherwise.
+     */
+    bool is_snapshot(const char *filename) {
+        std::ifstream file(filename, std::ios::binary);
+        char magic[sizeof(MAGIC)];
+
+        if (!file.read(magic, sizeof(magic))) {
+            return false;
+        }
+
+        return std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+    }
+
+
+    /**
+     * @brief Checks that the arrays of a mapped snapshot describe a valid matrix, so that no index read from them can
+     * fall outside the vectors and no degree the solvers divide by is wrong: COL_PTR starts at 0, never decreases and
+     * ends at NNZ, every row index is in [0, n), OUT_DEGREE[j] is the number of entries of column j, and the null
+     * columns are exactly the columns without entries, in increasing order.
+     *
+     * @param M The mapped matrix.
+     * @return true if the arrays are consistent, false otherwise.
+     */
+    bool validate(const Mapped_CSC *M) {
+        if (M->COL_PTR[0] != 0 || M->COL_PTR[M->n] != M->NNZ) {
+            return false;
+        }
+
+        // Accumulated without early exits, so that the loops stay branch-light over large arrays
+        bool valid = true;
+        long zero_degrees = 0;
+        for (long j = 0; j < M->n; j++) {
+            valid &= M->COL_PTR[j] <= M->COL_PTR[j + 1];
+            valid &= M->OUT_DEGREE[j] == M->COL_PTR[j + 1] - M->COL_PTR[j];
+            zero_degrees += M->OUT_DEGREE[j] == 0;
+        }
+
+        // Both bounds in a single unsigned comparison
+        for (long k = 0; k < M->NNZ; k++) {
+            valid &= (unsigned long)M->ROW_INDEX[k] < (unsigned long)M->n;
+        }
+
+        // Increasing indexes in [0, n) list every column at most once
+        for (long k = 0; k < M->num_null_cols; k++) {
+            valid &= (unsigned long)M->indexes_null_cols[k] < (unsigned long)M->n;
+        }
+        for (long k = 1; k < M->num_null_cols; k++) {
+            valid &= M->indexes_null_cols[k - 1] < M->indexes_null_cols[k];
+        }
+        if (!valid || zero_degrees != M->num_null_cols) {
+            return false;
+        }
+
+        // As many distinct columns as there are columns without entries, so they are exactly those if all are empty
+        for (long k = 0; k < M->num_null_cols; k++) {
+            valid &= M->OUT_DEGREE[M->indexes_null_cols[k]] == 0;
+        }
+
+        return valid;
+    }
+
+
+    /**
+     * @brief Maps a snapshot file into memory and returns a matrix whose arrays point into the mapping.
+     *
+     * The header is always checked against the size of the file. With check_arrays set, the arrays are also read once
+     * by validate, which loads all the pages; otherwise nothing is read eagerly and the pages are loaded by the
+     * operating system on first access, so only trusted files should be mapped without it.
+     *
+     * @param filename The name of the snapshot file.
+     * @param check_arrays Whether to validate the arrays before returning. Defaults to true.
+     * @return A pointer to the Mapped_CSC object representing the graph.
+     */
+    Mapped_CSC* map_graph_CSC(const char *filename, bool check_arrays = true) {
+        int fd = open(filename, O_RDONLY);
+        if (fd < 0) {
+            std::cout << "Unable to open file" << std::endl;
+            exit(1);
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(Header)) {
+            std::cout << "Invalid snapshot file" << std::endl;
+            exit(1);
+        }
+
+        void *base = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+
+        if (base == MAP_FAILED) {
+            std::cout << "Unable to map file" << std::endl;
+            exit(1);
+        }
+
+        const Header *h = static_cast<const Header*>(base);
+        if (std::memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0 || h->byte_order != ENDIAN_CHECK) {
+            std::cout << "Invalid snapshot file" << std::endl;
+            exit(1);
+        }
+        if (h->version != VERSION) {
+            std::cout << "Unsupported snapshot version: " << h->version << std::endl;
+            exit(1);
+        }
+
+        // Every array must fit in the file, which also keeps the offsets computed by make_header from overflowing
+        const int64_t max_len = st.st_size / sizeof(int64_t);
+        if (h->n < 0 || h->NNZ < 0 || h->num_null_cols < 0 ||
+            h->n >= max_len || h->NNZ > max_len || h->num_null_cols > max_len) {
+            std::cout << "Corrupted snapshot file" << std::endl;
+            exit(1);
+        }
+
+        const Header expected = make_header(h->n, h->NNZ, h->num_null_cols);
+        if (h->col_ptr_offset != expected.col_ptr_offset || h->row_index_offset != expected.row_index_offset ||
+            h->out_degree_offset != expected.out_degree_offset || h->null_cols_offset != expected.null_cols_offset ||
+            h->file_size != expected.file_size || h->file_size != st.st_size) {
+            std::cout << "Corrupted snapshot file" << std::endl;
+            exit(1);
+        }
+
+        const char *bytes = static_cast<const char*>(base);
+
+        Mapped_CSC *M = new Mapped_CSC();
+        M->base = base;
+        M->size = st.st_size;
+        M->n = h->n;
+        M->NNZ = h->NNZ;
+        M->num_null_cols = h->num_null_cols;
+        M->COL_PTR = reinterpret_cast<const long*>(bytes + h->col_ptr_offset);
+        M->ROW_INDEX = reinterpret_cast<const long*>(bytes + h->row_index_offset);
+        M->OUT_DEGREE = reinterpret_cast<const long*>(bytes + h->out_degree_offset);
+        M->indexes_null_cols = reinterpret_cast<const long*>(bytes + h->null_cols_offset);
+
+        if (check_arrays && !validate(M)) {
+            std::cout << "Corrupted snapshot file" << std::endl;
+            exit(1);
+        }
+
+        return M;
+    }
+}
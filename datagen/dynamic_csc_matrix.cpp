@@ -0,0 +1,201 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+
+#include "seq_csc_matrix.cpp"
+
+namespace sequential {
+
+    // ------------------ Dynamic matrix struct ------------------
+
+    /**
+     * @struct Dynamic_CSC_Matrix
+     * @brief A graph that accepts edge insertions and deletions on top of a CSC matrix.
+     *
+     * The changes are kept in a per-source delta buffer (inserted and deleted destinations) over an immutable
+     * CSC_Matrix, and folded back into a new CSC_Matrix by compact() once the buffer grows past a fraction of the
+     * edges. The number of nodes is fixed and the graph is treated as a set of edges: inserting an existing edge or
+     * deleting a missing one does nothing, so the initial matrix must not contain repeated edges (see
+     * edge_list::Parse_Options::remove_duplicates).
+     */
+    struct Dynamic_CSC_Matrix {
+        long n, NNZ;
+        CSC_Matrix *base;                                       // The compacted edges, owned
+        std::vector<long> OUT_DEGREE;                           // len = n, including the delta
+        std::unordered_map<long, std::vector<long>> inserted;   // Per source, the destinations added to base
+        std::unordered_map<long, std::vector<long>> deleted;    // Per source, the destinations removed from base
+        long delta_size = 0;
+        double compaction_ratio;
+
+
+        /**
+         * @brief Initializes a Dynamic_CSC_Matrix taking ownership of a CSC_Matrix.
+         *
+         * @param M The initial matrix.
+         * @param compaction_ratio The size of the delta buffer, as a fraction of the edges, that triggers a compaction. Defaults to 0.05.
+         */
+        explicit Dynamic_CSC_Matrix(CSC_Matrix *M, double compaction_ratio = 0.05)
+            : n(M->n), NNZ(M->NNZ), base(M), OUT_DEGREE(M->OUT_DEGREE), compaction_ratio(compaction_ratio) {}
+
+        Dynamic_CSC_Matrix(const Dynamic_CSC_Matrix&) = delete;
+        Dynamic_CSC_Matrix& operator=(const Dynamic_CSC_Matrix&) = delete;
+
+        ~Dynamic_CSC_Matrix() {
+            delete base;
+        }
+
+
+        /**
+         * @brief Calls f(destination) for every out-edge of the given node.
+         *
+         * @param u The source node.
+         * @param f The function to call.
+         */
+        template <typename F>
+        void for_each_out_edge(long u, F f) const {
+            auto del = deleted.find(u);
+            for (long j = base->COL_PTR[u]; j < base->COL_PTR[u + 1]; j++) {
+                long v = base->ROW_INDEX[j];
+                if (del != deleted.end() && std::find(del->second.begin(), del->second.end(), v) != del->second.end()) continue;
+                f(v);
+            }
+
+            auto ins = inserted.find(u);
+            if (ins != inserted.end()) {
+                for (long v : ins->second) f(v);
+            }
+        }
+
+
+        /**
+         * @brief Checks whether the edge from u to v is in the graph.
+         */
+        bool has_edge(long u, long v) const {
+            bool found = false;
+            for_each_out_edge(u, [&](long w) { found |= w == v; });
+            return found;
+        }
+
+
+        /**
+         * @brief Adds the edge from u to v.
+         *
+         * @return true if the edge was added, false if it was already in the graph.
+         */
+        bool insert_edge(long u, long v) {
+            check_node(u);
+            check_node(v);
+            if (has_edge(u, v)) return false;
+
+            if (!erase(deleted, u, v)) {
+                inserted[u].push_back(v);
+                delta_size++;
+            }
+
+            OUT_DEGREE[u]++;
+            NNZ++;
+            return true;
+        }
+
+
+        /**
+         * @brief Removes the edge from u to v.
+         *
+         * @return true if the edge was removed, false if it was not in the graph.
+         */
+        bool delete_edge(long u, long v) {
+            check_node(u);
+            check_node(v);
+            if (!has_edge(u, v)) return false;
+
+            if (!erase(inserted, u, v)) {
+                deleted[u].push_back(v);
+                delta_size++;
+            }
+
+            OUT_DEGREE[u]--;
+            NNZ--;
+            return true;
+        }
+
+
+        /**
+         * @brief Compacts the graph if the delta buffer is larger than compaction_ratio times the edges.
+         *
+         * @return true if the graph was compacted.
+         */
+        bool maybe_compact() {
+            if (delta_size <= compaction_ratio * std::max<long>(NNZ, 1)) return false;
+
+            compact();
+            return true;
+        }
+
+
+        /**
+         * @brief Folds the delta buffer into a new CSC_Matrix.
+         */
+        void compact() {
+            CSC_Matrix *M = new CSC_Matrix(n, NNZ);
+
+            long k = 0;
+            for (long u = 0; u < n; u++) {
+                M->COL_PTR[u] = k;
+                for_each_out_edge(u, [&](long v) { M->ROW_INDEX[k++] = v; });
+
+                M->OUT_DEGREE[u] = OUT_DEGREE[u];
+                if (OUT_DEGREE[u] == 0) {
+                    M->indexes_null_cols.push_back(u);
+                }
+            }
+            M->COL_PTR[n] = k;
+            M->num_null_cols = M->indexes_null_cols.size();
+
+            delete base;
+            base = M;
+            inserted.clear();
+            deleted.clear();
+            delta_size = 0;
+        }
+
+
+        /**
+         * @brief Returns the graph as a CSC_Matrix, compacting the delta buffer first.
+         *
+         * @return A pointer to the matrix, owned by the Dynamic_CSC_Matrix and valid until the next compaction.
+         */
+        CSC_Matrix* matrix() {
+            if (delta_size != 0) compact();
+            return base;
+        }
+
+
+    private:
+        void check_node(long u) const {
+            if (u < 0 || u >= n) {
+                std::cout << "Node out of range: " << u << std::endl;
+                exit(1);
+            }
+        }
+
+        /**
+         * @brief Removes v from the list of u in the given delta map, if present.
+         */
+        bool erase(std::unordered_map<long, std::vector<long>> &delta, long u, long v) {
+            auto it = delta.find(u);
+            if (it == delta.end()) return false;
+
+            auto pos = std::find(it->second.begin(), it->second.end(), v);
+            if (pos == it->second.end()) return false;
+
+            *pos = it->second.back();
+            it->second.pop_back();
+            if (it->second.empty()) delta.erase(it);
+            delta_size--;
+            return true;
+        }
+    };
+}
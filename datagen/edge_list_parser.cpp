@@ -0,0 +1,503 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <charconv>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @namespace edge_list
+ * @brief Contains a multi-threaded parser that builds the CSC arrays directly from a memory-mapped SNAP edge list.
+ *
+ * The file is never copied into strings: it is mapped, split into newline-aligned chunks and every chunk is parsed
+ * with std::from_chars by its own thread. When compiled without -fopenmp the same code simply runs on one thread.
+ */
+namespace edge_list {
+
+    // ------------------ Parsed matrix ------------------
+
+    /**
+     * @struct CSC_Arrays
+     * @brief The arrays of a graph adjacency matrix in CSC format, as produced by the parser.
+     */
+    struct CSC_Arrays {
+        long n = 0, NNZ = 0;
+        std::vector<long> ROW_INDEX;         // len = NNZ
+        std::vector<long> COL_PTR;           // len = n + 1
+        std::vector<long> OUT_DEGREE;        // len = n
+        std::vector<long> indexes_null_cols; // len = num_null_cols
+    };
+
+
+    // ------------------ Mapped file ------------------
+
+    /**
+     * @struct Mapped_File
+     * @brief A read-only memory mapping of a whole file.
+     */
+    struct Mapped_File {
+        const char *data = nullptr;
+        size_t size = 0;
+
+        Mapped_File(const char *filename) {
+            int fd = open(filename, O_RDONLY);
+            if (fd < 0) {
+                std::cout << "Unable to open file" << std::endl;
+                exit(1);
+            }
+
+            struct stat st;
+            fstat(fd, &st);
+            size = st.st_size;
+
+            if (size > 0) {
+                void *p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p == MAP_FAILED) {
+                    std::cout << "Unable to map file" << std::endl;
+                    exit(1);
+                }
+                madvise(p, size, MADV_SEQUENTIAL);
+                data = static_cast<const char*>(p);
+            }
+            close(fd);
+        }
+
+        Mapped_File(const Mapped_File&) = delete;
+        Mapped_File& operator=(const Mapped_File&) = delete;
+
+        ~Mapped_File() {
+            if (data != nullptr) {
+                munmap(const_cast<char*>(data), size);
+            }
+        }
+    };
+
+
+    // ------------------ Parsing helpers ------------------
+
+    inline bool is_blank(char c) {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+
+    /**
+     * @brief Returns a pointer to the character following the next newline, or to end if there is none.
+     */
+    inline const char* next_line(const char *p, const char *end) {
+        const char *nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        return nl == nullptr ? end : nl + 1;
+    }
+
+
+    /**
+     * @brief Parses the line starting at p as an edge "<from> <to>".
+     *
+     * @return true if the line contains an edge, false if it is blank or a comment.
+     */
+    inline bool parse_edge(const char *&p, const char *end, long &from, long &to) {
+        while (p < end && is_blank(*p)) p++;
+
+        if (p == end || *p == '\n' || *p == '#') {
+            p = next_line(p, end);
+            return false;
+        }
+
+        auto r = std::from_chars(p, end, from);
+        p = r.ptr;
+        while (p < end && is_blank(*p)) p++;
+        auto r2 = std::from_chars(p, end, to);
+
+        if (r.ec != std::errc() || r2.ec != std::errc()) {
+            std::cout << "Malformed edge list" << std::endl;
+            exit(1);
+        }
+
+        p = next_line(r2.ptr, end);
+        return true;
+    }
+
+
+    /**
+     * @brief Reads the comment lines at the beginning of the file, looking for the "Nodes: <n> Edges: <NNZ>" line.
+     *
+     * @param n Set to the number of nodes, or -1 if the header does not declare it.
+     * @param NNZ Set to the number of edges, or -1 if the header does not declare it.
+     * @return A pointer to the first line after the header.
+     */
+    const char* read_header(const char *p, const char *end, long &n, long &NNZ) {
+        n = -1; NNZ = -1;
+
+        while (p < end && *p == '#') {
+            const char *eol = next_line(p, end);
+            std::string line(p, eol);
+
+            size_t pos_n = line.find("Nodes:");
+            size_t pos_e = line.find("Edges:");
+            if (pos_n != std::string::npos && pos_e != std::string::npos) {
+                n = std::stol(line.substr(pos_n + 6));
+                NNZ = std::stol(line.substr(pos_e + 6));
+            }
+
+            p = eol;
+        }
+
+        return p;
+    }
+
+
+    // ------------------ Parallel construction helpers ------------------
+
+    /**
+     * @struct Parse_Options
+     * @brief Optional clean-up steps applied to every column after the matrix is built.
+     */
+    struct Parse_Options {
+        bool sort_columns = false;      // Sort the rows of every column
+        bool remove_duplicates = false; // Keep a single copy of repeated edges (implies sort_columns)
+    };
+
+
+    /**
+     * @brief Computes COL_PTR as the exclusive prefix sum of the out degrees.
+     *
+     * Each block sums its own part, then adds the total of the previous blocks.
+     *
+     * @param OUT_DEGREE The out degree array (len = n).
+     * @param COL_PTR The column pointer array to fill (len = n + 1).
+     * @param threads The number of threads to use.
+     */
+    void prefix_sum(const std::vector<long> &OUT_DEGREE, std::vector<long> &COL_PTR, int threads) {
+        long n = OUT_DEGREE.size();
+        COL_PTR.resize(n + 1);
+        COL_PTR[0] = 0;
+
+        int num_blocks = threads;
+        std::vector<long> block_sum(num_blocks + 1, 0);
+
+        #pragma omp parallel for num_threads(threads) schedule(static, 1)
+        for (int b = 0; b < num_blocks; b++) {
+            long lo = n * b / num_blocks, hi = n * (b + 1) / num_blocks, sum = 0;
+            for (long i = lo; i < hi; i++) {
+                sum += OUT_DEGREE[i];
+                COL_PTR[i + 1] = sum;
+            }
+            block_sum[b + 1] = sum;
+        }
+
+        for (int b = 0; b < num_blocks; b++) {
+            block_sum[b + 1] += block_sum[b];
+        }
+
+        #pragma omp parallel for num_threads(threads) schedule(static, 1)
+        for (int b = 0; b < num_blocks; b++) {
+            long lo = n * b / num_blocks, hi = n * (b + 1) / num_blocks;
+            for (long i = lo; i < hi; i++) {
+                COL_PTR[i + 1] += block_sum[b];
+            }
+        }
+    }
+
+
+    /**
+     * @brief Collects, in increasing order, the indexes of the columns with no edges.
+     */
+    std::vector<long> find_null_cols(const std::vector<long> &OUT_DEGREE, int threads) {
+        long n = OUT_DEGREE.size();
+        std::vector<std::vector<long>> block_null_cols(threads);
+
+        #pragma omp parallel for num_threads(threads) schedule(static, 1)
+        for (int b = 0; b < threads; b++) {
+            for (long i = n * b / threads; i < n * (b + 1) / threads; i++) {
+                if (OUT_DEGREE[i] == 0) block_null_cols[b].push_back(i);
+            }
+        }
+
+        std::vector<long> indexes_null_cols;
+        for (int b = 0; b < threads; b++) {
+            indexes_null_cols.insert(indexes_null_cols.end(), block_null_cols[b].begin(), block_null_cols[b].end());
+        }
+
+        return indexes_null_cols;
+    }
+
+
+    /**
+     * @brief Sorts the rows of every column and optionally removes the repeated ones, compacting the arrays.
+     *
+     * @param M The matrix to clean up. COL_PTR, ROW_INDEX and OUT_DEGREE must already be filled.
+     * @param remove_duplicates Whether to remove the repeated rows.
+     * @param threads The number of threads to use.
+     */
+    void clean_columns(CSC_Arrays &M, bool remove_duplicates, int threads) {
+        #pragma omp parallel for num_threads(threads) schedule(dynamic, 1024)
+        for (long i = 0; i < M.n; i++) {
+            std::sort(M.ROW_INDEX.begin() + M.COL_PTR[i], M.ROW_INDEX.begin() + M.COL_PTR[i + 1]);
+        }
+
+        if (!remove_duplicates) return;
+
+        // Count the distinct rows of every column, then move them to their new position
+        std::vector<long> degree(M.n);
+
+        #pragma omp parallel for num_threads(threads) schedule(dynamic, 1024)
+        for (long i = 0; i < M.n; i++) {
+            auto first = M.ROW_INDEX.begin() + M.COL_PTR[i], last = M.ROW_INDEX.begin() + M.COL_PTR[i + 1];
+            degree[i] = std::unique(first, last) - first;
+        }
+
+        std::vector<long> col_ptr;
+        prefix_sum(degree, col_ptr, threads);
+
+        std::vector<long> row_index(col_ptr[M.n]);
+
+        #pragma omp parallel for num_threads(threads) schedule(dynamic, 1024)
+        for (long i = 0; i < M.n; i++) {
+            std::copy(M.ROW_INDEX.begin() + M.COL_PTR[i], M.ROW_INDEX.begin() + M.COL_PTR[i] + degree[i], row_index.begin() + col_ptr[i]);
+        }
+
+        M.NNZ = col_ptr[M.n];
+        M.COL_PTR = std::move(col_ptr);
+        M.ROW_INDEX = std::move(row_index);
+        M.OUT_DEGREE = std::move(degree);
+    }
+
+
+    /**
+     * @brief Builds COL_PTR, ROW_INDEX and OUT_DEGREE from the chunks of an edge list that is not sorted by source.
+     *
+     * A direct scatter of every edge into its column is a random write over the whole ROW_INDEX, so the edges are first
+     * binned by source range into buckets small enough to stay in cache. Since the buckets are ordered by source, each
+     * bucket ends up exactly where its columns go in ROW_INDEX, and a thread can then sort it by column locally:
+     * no atomic operations are needed and the edges of every column keep the order of the file.
+     *
+     * @param M The matrix to fill. n, NNZ and the size of ROW_INDEX must already be set.
+     * @param bounds The newline-aligned chunks of the file.
+     * @param chunk_offset The index of the first edge of every chunk (len = num_chunks + 1).
+     * @param threads The number of threads to use.
+     */
+    void build_unsorted(CSC_Arrays &M, const std::vector<const char*> &bounds, const std::vector<long> &chunk_offset, int threads) {
+        int num_chunks = bounds.size() - 1;
+        long n = M.n, NNZ = M.NNZ;
+
+        // About 128k edges per bucket, at least a few buckets per thread
+        long num_buckets = std::max<long>(threads * 4, NNZ >> 17);
+        num_buckets = std::min(num_buckets, std::max(n, 1L));
+        long width = (n + num_buckets - 1) / num_buckets;
+        num_buckets = std::max(n, 1L) / width + (std::max(n, 1L) % width != 0);
+
+        // Parse the chunks, keeping the edges in file order and counting them per (chunk, bucket)
+        std::vector<long> from_ids(NNZ), to_ids(NNZ);
+        std::vector<long> count(num_chunks * num_buckets, 0);
+
+        #pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
+        for (int c = 0; c < num_chunks; c++) {
+            const char *p = bounds[c];
+            long k = chunk_offset[c], from, to;
+            while (p < bounds[c + 1]) {
+                if (!parse_edge(p, bounds[c + 1], from, to)) continue;
+
+                from_ids[k] = from;
+                to_ids[k++] = to;
+                count[c * num_buckets + from / width]++;
+            }
+        }
+
+        // Bucket-major offsets: the edges of bucket b from chunk c follow those of the previous chunks
+        std::vector<long> bucket_start(num_buckets + 1, 0);
+        long offset = 0;
+        for (long b = 0; b < num_buckets; b++) {
+            bucket_start[b] = offset;
+            for (int c = 0; c < num_chunks; c++) {
+                long tmp = count[c * num_buckets + b];
+                count[c * num_buckets + b] = offset;
+                offset += tmp;
+            }
+        }
+        bucket_start[num_buckets] = offset;
+
+        // Bin the edges, with the destinations already in their final region of ROW_INDEX
+        std::vector<long> bucket_from(NNZ);
+
+        #pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
+        for (int c = 0; c < num_chunks; c++) {
+            long *cursor = &count[c * num_buckets];
+            for (long k = chunk_offset[c]; k < chunk_offset[c + 1]; k++) {
+                long pos = cursor[from_ids[k] / width]++;
+                bucket_from[pos] = from_ids[k];
+                M.ROW_INDEX[pos] = to_ids[k];
+            }
+        }
+
+        std::vector<long>().swap(from_ids);
+        std::vector<long>().swap(to_ids);
+
+        // Every bucket owns its columns, so the out degrees are counted without atomics
+        M.OUT_DEGREE.assign(n, 0);
+
+        #pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
+        for (long b = 0; b < num_buckets; b++) {
+            for (long k = bucket_start[b]; k < bucket_start[b + 1]; k++) {
+                M.OUT_DEGREE[bucket_from[k]]++;
+            }
+        }
+
+        prefix_sum(M.OUT_DEGREE, M.COL_PTR, threads);
+
+        // Stable counting sort of every bucket by column, inside its own region of ROW_INDEX
+        #pragma omp parallel num_threads(threads)
+        {
+            std::vector<long> rows, cursor(width);
+
+            #pragma omp for schedule(dynamic, 1)
+            for (long b = 0; b < num_buckets; b++) {
+                long lo = b * width, hi = std::min(n, lo + width);
+                rows.assign(M.ROW_INDEX.begin() + bucket_start[b], M.ROW_INDEX.begin() + bucket_start[b + 1]);
+                std::copy(M.COL_PTR.begin() + lo, M.COL_PTR.begin() + hi, cursor.begin());
+
+                for (long k = bucket_start[b]; k < bucket_start[b + 1]; k++) {
+                    M.ROW_INDEX[cursor[bucket_from[k] - lo]++] = rows[k - bucket_start[b]];
+                }
+            }
+        }
+    }
+
+
+    // ------------------ Parallel parser ------------------
+
+    /**
+     * @brief Parses an edge list and builds its CSC arrays. The edges can be in any order.
+     *
+     * The body of the file is split into newline-aligned chunks. A first parallel pass counts the edges of every chunk
+     * and checks whether the file is sorted by FromNodeId.
+     *
+     * If it is sorted, after a prefix sum each chunk knows where its edges start in ROW_INDEX, and a second parallel
+     * pass parses the chunks again, writing the destinations in place and counting the out degrees.
+     *
+     * Otherwise the edges are binned by source and sorted by column in cache-sized buckets, see build_unsorted.
+     *
+     * @param filename The name of the graph file.
+     * @param threads The number of threads to use.
+     * @param options The clean-up steps applied to the columns. Defaults to none.
+     * @return The CSC arrays of the graph.
+     */
+    CSC_Arrays parse_CSC(const char *filename, int threads, Parse_Options options = Parse_Options()) {
+        Mapped_File file(filename);
+        const char *begin = file.data, *end = file.data + file.size;
+
+        long n, NNZ;
+        const char *body = read_header(begin, end, n, NNZ);
+
+        // Split the body into newline-aligned chunks
+        int num_chunks = threads * 4;
+        std::vector<const char*> bounds(num_chunks + 1);
+        bounds[0] = body;
+        bounds[num_chunks] = end;
+        for (int c = 1; c < num_chunks; c++) {
+            const char *p = body + (end - body) * c / num_chunks;
+            bounds[c] = p <= bounds[c-1] ? bounds[c-1] : next_line(p - 1, end);
+        }
+
+        // First pass: count the edges of every chunk, find the largest node id and check the order of the sources
+        std::vector<long> chunk_offset(num_chunks + 1, 0), max_id(num_chunks, -1);
+        std::vector<long> chunk_first(num_chunks, -1), chunk_last(num_chunks, -1);
+        std::vector<char> chunk_sorted(num_chunks, 1);
+
+        #pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
+        for (int c = 0; c < num_chunks; c++) {
+            const char *p = bounds[c];
+            long count = 0, local_max = -1, prev = -1, from, to;
+            while (p < bounds[c + 1]) {
+                if (!parse_edge(p, bounds[c + 1], from, to)) continue;
+
+                if (from < 0 || to < 0) {
+                    std::cout << "Negative node id in edge list" << std::endl;
+                    exit(1);
+                }
+                if (from < prev) chunk_sorted[c] = 0;
+                if (prev < 0) chunk_first[c] = from;
+                prev = from;
+
+                local_max = std::max(local_max, std::max(from, to));
+                count++;
+            }
+            chunk_offset[c + 1] = count;
+            max_id[c] = local_max;
+            chunk_last[c] = prev;
+        }
+
+        long largest = -1, last = -1;
+        bool sorted = true;
+        for (int c = 0; c < num_chunks; c++) {
+            chunk_offset[c + 1] += chunk_offset[c];
+            largest = std::max(largest, max_id[c]);
+
+            if (!chunk_sorted[c] || (chunk_first[c] >= 0 && chunk_first[c] < last)) sorted = false;
+            if (chunk_last[c] >= 0) last = chunk_last[c];
+        }
+
+        if (NNZ >= 0 && NNZ != chunk_offset[num_chunks]) {
+            std::cout << "Warning: the header declares " << NNZ << " edges, found " << chunk_offset[num_chunks] << std::endl;
+        }
+        NNZ = chunk_offset[num_chunks];
+
+        if (n < 0) n = largest + 1;
+        if (largest >= n) {
+            std::cout << "Node id " << largest << " out of range" << std::endl;
+            exit(1);
+        }
+
+        CSC_Arrays M;
+        M.n = n;
+        M.NNZ = NNZ;
+        M.ROW_INDEX.resize(NNZ);
+        M.OUT_DEGREE.assign(n, 0);
+
+        if (sorted) {
+            // Second pass: write the destinations in place and count the out degrees. Inside a chunk the edges of a
+            // node are contiguous, so only one atomic update per run of equal sources is needed
+            #pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
+            for (int c = 0; c < num_chunks; c++) {
+                const char *p = bounds[c];
+                long k = chunk_offset[c], from, to, prev = -1, run = 0;
+                while (p < bounds[c + 1]) {
+                    if (!parse_edge(p, bounds[c + 1], from, to)) continue;
+
+                    if (from != prev) {
+                        if (run > 0) {
+                            #pragma omp atomic
+                            M.OUT_DEGREE[prev] += run;
+                        }
+                        prev = from;
+                        run = 0;
+                    }
+                    run++;
+
+                    M.ROW_INDEX[k++] = to;
+                }
+                if (run > 0) {
+                    #pragma omp atomic
+                    M.OUT_DEGREE[prev] += run;
+                }
+            }
+
+            prefix_sum(M.OUT_DEGREE, M.COL_PTR, threads);
+        } else {
+            build_unsorted(M, bounds, chunk_offset, threads);
+        }
+
+        if (options.sort_columns || options.remove_duplicates) {
+            clean_columns(M, options.remove_duplicates, threads);
+        }
+
+        M.indexes_null_cols = find_null_cols(M.OUT_DEGREE, threads);
+
+        return M;
+    }
+}
@@ -0,0 +1,58 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <chrono>
+
+#include "synthetic_graph.cpp"
+
+// Generates an R-MAT, Kronecker or uniform random graph of 2^scale nodes and edge_factor * 2^scale edges, as a SNAP
+// edge list or as a binary CSC snapshot.
+// g++ graph_gen.cpp -O3 -fopenmp -o graph_gen.exe
+int main(int argc, char *argv[]) {
+    if (argc < 5 || argc > 8) {
+        std::cout << "Usage: " << argv[0] << " <uniform|rmat|kronecker> <scale> <edge_factor> <output_file> [text|csc] [threads] [seed]" << std::endl;
+        return 1;
+    }
+
+    synthetic::Generator_Options options;
+    const std::string model = argv[1];
+    if (model == "uniform") {
+        options.model = synthetic::Model::UNIFORM;
+    } else if (model == "rmat") {
+        options.model = synthetic::Model::RMAT;
+    } else if (model == "kronecker") {
+        options.model = synthetic::Model::KRONECKER;
+    } else {
+        std::cout << "Unknown model: " << model << std::endl;
+        return 1;
+    }
+
+    options.scale = atoi(argv[2]);
+    options.edge_factor = atol(argv[3]);
+    const char *output = argv[4];
+    const std::string format = argc >= 6 ? argv[5] : "text";
+    if (argc >= 7) options.threads = atoi(argv[6]);
+    if (argc == 8) options.seed = strtoull(argv[7], nullptr, 10);
+
+    if (format != "text" && format != "csc") {
+        std::cout << "Unknown format: " << format << std::endl;
+        return 1;
+    }
+
+    synthetic::Generator G(options);
+    std::cout << "Generating " << G.n << " nodes and " << G.NNZ << " edges" << std::endl;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    if (format == "csc") {
+        synthetic::write_snapshot(G, output);
+    } else {
+        synthetic::write_text(G, output);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double> elapsed = end - start;
+    std::cout << "Graph written to " << output << " in " << elapsed.count() << " s ("
+              << G.NNZ / elapsed.count() * 1e-6 << " Medges/s)" << std::endl;
+
+    return 0;
+}
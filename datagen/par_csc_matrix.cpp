@@ -1,3 +1,5 @@
+#pragma once
+
 #include <iostream>
 #include <fstream>
 #include <vector>
@@ -7,6 +9,12 @@
 #include <chrono>
 #include <cmath>
 #include <numeric>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
+
+#include "csc_snapshot.cpp"
+#include "edge_list_parser.cpp"
 
 
 /**
@@ -18,26 +26,32 @@ namespace parallel {
 
     /**
      * @struct CSC_Matrix
-     * @brief Represents a graph adjacency matrix in Compressed Sparse Column (CSC) format.
+     * @brief Represents a row partition of a graph adjacency matrix in Compressed Sparse Column (CSC) format.
+     * 
+     * Only the columns with at least one edge into the rows of the partition are stored, each with its index in
+     * COL_ID, and only the out degrees of the rows of the partition are kept, so all the partitions together take
+     * O(n + NNZ) memory whatever the number of cores.
      */
     struct CSC_Matrix {
         long n, m, NNZ, num_null_cols;
-        std::vector<long> ROW_INDEX;         // len = NNZ
-        std::vector<long> COL_PTR;           // len = n + 1
-        std::vector<long> OUT_DEGREE;        // len = n
+        long first_row;                      // Index in the whole graph of the first row of the partition
+        std::vector<long> ROW_INDEX;         // len = NNZ, rows relative to first_row
+        std::vector<long> COL_ID;            // len = cols, the columns with an edge into the partition, in increasing order
+        std::vector<long> COL_PTR;           // len = cols + 1
+        std::vector<long> OUT_DEGREE;        // len = m, the out degree of the rows of the partition
         std::vector<long> indexes_null_cols; // len = num_null_cols
 
 
         /**
-         * @brief Initializes a CSC_Matrix object with the given number of nodes and non-zero elements.
+         * @brief Initializes an empty partition of the matrix with the given number of columns and rows.
          * 
          * @param n The number of nodes in the graph.
-         * @param NNZ The number of non-zero elements in the graph.
+         * @param m The number of rows of the partition.
+         * @param first_row The index of the first row of the partition. Defaults to 0.
          */
-        CSC_Matrix(long n, long m) : n(n), m(m) {
+        CSC_Matrix(long n, long m, long first_row = 0) : n(n), m(m), num_null_cols(0), first_row(first_row) {
             NNZ = 0;
-            COL_PTR.resize(n + 1);
-            COL_PTR[0] = 0;
+            COL_PTR.push_back(0);
         }
 
 
@@ -55,26 +69,35 @@ namespace parallel {
 
         
         /**
-         * @brief Adds a column to the compressed sparse column (CSC) matrix.
+         * @brief Closes column i - 1, once all its edges have been added.
          * 
-         * This function updates the column pointer array `COL_PTR` by setting the value at index `i` to the current number of non-zero elements (`NNZ`).
+         * The column is only stored, with its index in `COL_ID` and the current number of non-zero elements (`NNZ`)
+         * in `COL_PTR`, if it received edges since the previous column.
          * 
-         * @param i The index of the column to be added.
+         * @param i The index of the column after the one being closed.
          */
         void add_col(long i) {
-            COL_PTR[i] = NNZ;
+            if (NNZ > COL_PTR.back()) {
+                COL_ID.push_back(i - 1);
+                COL_PTR.push_back(NNZ);
+            }
         }
         
 
         /**
          * @brief Calculates the value of the element in position (i, j) of the matrix.
          * 
-         * @param i The index of the source node.
-         * @param j The index of the destination node.
-         * @return 1 if there is an edge from i to j, 0 otherwise.
+         * @param i The index of the destination node, relative to first_row.
+         * @param j The index of the source node.
+         * @return 1 if there is an edge from j to i, 0 otherwise.
          */
         int access(long i, long j) {
-            for (long k = COL_PTR[j]; k < COL_PTR[j+1]; k++) {
+            long c = std::lower_bound(COL_ID.begin(), COL_ID.end(), j) - COL_ID.begin();
+            if (c == (long)COL_ID.size() || COL_ID[c] != j) {
+                return 0;
+            }
+
+            for (long k = COL_PTR[c]; k < COL_PTR[c+1]; k++) {
                 if (ROW_INDEX[k] == i) {
                     return 1;
                 }
@@ -85,21 +108,18 @@ namespace parallel {
 
 
         /**
-         * Multiplies the vector with the given vector `v`.
+         * Adds to `result` the product of the partition with the contributions v[i]/OUT_DEGREE[i] already computed.
          * 
-         * @param v The vector to be multiplied with.
-         * @return A pointer to a new vector that is the result of the multiplication.
+         * @param contrib The contribution of every node (len = n).
+         * @param result The vector the result is added to (len = m).
          */
-        std::vector<double>* operator*(std::vector<double> &v) {
-            std::vector<double> *result = new std::vector<double>(m, 0);
-
-            for (long i = 0; i < n; i++) {
-                for (long j = COL_PTR[i]; j < COL_PTR[i + 1]; j++) {
-                    (*result)[ROW_INDEX[j]] += v[i] / OUT_DEGREE[i];
+        void multiply_add(const double *contrib, double *result) {
+            for (long c = 0; c < (long)COL_ID.size(); c++) {
+                double x = contrib[COL_ID[c]];
+                for (long j = COL_PTR[c]; j < COL_PTR[c + 1]; j++) {
+                    result[ROW_INDEX[j]] += x;
                 }
             }
-
-            return result;
         }
 
 
@@ -131,10 +151,11 @@ namespace parallel {
         void print_info(int max_el = 20) {
             std::cout << "Nodes: " << n << std::endl;
             std::cout << "Edges: " << NNZ << std::endl;
+            std::cout << "Rows: " << first_row << " - " << first_row + m - 1 << std::endl;
 
-            int max1 = max_el < n ? max_el : n;
+            int max1 = max_el < m ? max_el : m;
             int max2 = max_el < NNZ ? max_el : NNZ;
-            int max3 = max_el < n + 1 ? max_el : n + 1;
+            int max3 = max_el < (long)COL_PTR.size() ? max_el : COL_PTR.size();
             int max4 = max_el < num_null_cols ? max_el : num_null_cols;
 
             std::cout << "Row index: ";
@@ -143,6 +164,12 @@ namespace parallel {
             }
             std::cout << std::endl;
 
+            std::cout << "Column id: ";
+            for (long i = 0; i < max3 - 1; i++) {
+                std::cout << COL_ID[i] << " ";
+            }
+            std::cout << std::endl;
+
             std::cout << "Column pointer: ";
             for (long i = 0; i < max3; i++) {
                 std::cout << COL_PTR[i] << " ";
@@ -166,6 +193,306 @@ namespace parallel {
     };
 
 
+    /**
+     * @brief Prints the rows and edges of every partition, and the edge imbalance between them.
+     * 
+     * The imbalance is the number of edges of the largest partition over the mean: 1 means perfectly balanced.
+     * 
+     * @param matrices The partitions of the matrix.
+     */
+    void print_partition_info(std::vector<CSC_Matrix*> &matrices) {
+        long total = 0, max_NNZ = 0;
+        for (CSC_Matrix *M : matrices) {
+            std::cout << "Partition rows " << M->first_row << " - " << M->first_row + M->m - 1 << ": " << M->NNZ << " edges" << std::endl;
+            total += M->NNZ;
+            max_NNZ = std::max(max_NNZ, M->NNZ);
+        }
+
+        double mean = (double)total / matrices.size();
+        std::cout << "Edge imbalance (max/mean): " << (mean > 0 ? max_NNZ / mean : 1) << std::endl;
+        std::cout << std::endl;
+    }
+
+
+    // ------------------ Row partitioning ------------------
+
+    /**
+     * @brief Splits the rows into contiguous ranges with about the same amount of work each.
+     * 
+     * The work of a row is its number of in-edges plus one, so that on power-law graphs a few rows with many in-edges
+     * get a partition of their own, while long runs of rows with no in-edges are still spread out.
+     * 
+     * @param in_edges_before Cumulative in-degree: in_edges_before[r] is the number of in-edges of rows 0..r-1 (len = n + 1).
+     * @param n The number of rows.
+     * @param parts The number of partitions.
+     * @return The first row of every partition, followed by n (len = parts + 1).
+     */
+    template <typename Index>
+    std::vector<long> balanced_row_bounds(const Index *in_edges_before, long n, int parts) {
+        std::vector<long> bounds(parts + 1);
+        long total = (long)in_edges_before[n] + n;
+
+        bounds[0] = 0;
+        for (int p = 1; p < parts; p++) {
+            long target = total * p / parts;
+
+            // First row r with in_edges_before[r] + r >= target
+            long lo = bounds[p - 1], hi = n;
+            while (lo < hi) {
+                long mid = lo + (hi - lo) / 2;
+                if ((long)in_edges_before[mid] + mid < target) lo = mid + 1; else hi = mid;
+            }
+            bounds[p] = lo;
+        }
+        bounds[parts] = n;
+
+        return bounds;
+    }
+
+
+    // ------------------ Transposed matrix struct ------------------
+
+    /**
+     * @brief Transposes the arrays of a whole-graph CSC matrix into the in-edges of every row.
+     * 
+     * The in-degrees are counted in parallel and every source is scattered into its row; the rows are then sorted,
+     * so the sources are read in increasing order during the multiplication.
+     * 
+     * @param n The number of nodes in the graph.
+     * @param NNZ The number of non-zero elements in the graph.
+     * @param COL_PTR The column pointer array (len = n + 1).
+     * @param ROW_INDEX The row index array (len = NNZ).
+     * @param ROW_PTR The vector where the row pointers are written (len = n + 1).
+     * @param COL_INDEX The vector where the sources of the in-edges are written (len = NNZ). Index must hold n.
+     * @param cores The number of cores to use for parallelization.
+     */
+    template <typename Index>
+    void transpose_CSC(long n, long NNZ, const long *COL_PTR, const long *ROW_INDEX, std::vector<long> &ROW_PTR,
+                       std::vector<Index> &COL_INDEX, int cores) {
+        std::vector<long> in_degree(n, 0);
+
+        #pragma omp parallel for num_threads(cores)
+        for (long j = 0; j < NNZ; j++) {
+            #pragma omp atomic
+            in_degree[ROW_INDEX[j]]++;
+        }
+
+        edge_list::prefix_sum(in_degree, ROW_PTR, cores);
+
+        COL_INDEX.resize(NNZ);
+        std::vector<long> cursor(ROW_PTR.begin(), ROW_PTR.end() - 1);
+
+        #pragma omp parallel for num_threads(cores) schedule(dynamic, 1024)
+        for (long i = 0; i < n; i++) {
+            for (long j = COL_PTR[i]; j < COL_PTR[i + 1]; j++) {
+                long k;
+
+                #pragma omp atomic capture
+                k = cursor[ROW_INDEX[j]]++;
+
+                COL_INDEX[k] = i;
+            }
+        }
+
+        #pragma omp parallel for num_threads(cores) schedule(dynamic, 1024)
+        for (long r = 0; r < n; r++) {
+            std::sort(COL_INDEX.begin() + ROW_PTR[r], COL_INDEX.begin() + ROW_PTR[r + 1]);
+        }
+    }
+
+
+    /**
+     * @struct CSR_Matrix
+     * @brief Represents a graph adjacency matrix in Compressed Sparse Row (CSR) format, i.e. the in-edges of every node.
+     * 
+     * A single instance is shared by all the cores: each core pulls the contributions of the in-edges of a contiguous
+     * range of rows, so the memory is O(n + NNZ) whatever the number of cores.
+     */
+    struct CSR_Matrix {
+        long n, NNZ, num_null_cols;
+        std::vector<long> COL_INDEX;         // len = NNZ, sources of the in-edges
+        std::vector<long> ROW_PTR;           // len = n + 1
+        std::vector<long> OUT_DEGREE;        // len = n
+        std::vector<long> indexes_null_cols; // len = num_null_cols
+
+
+        /**
+         * @brief Builds the CSR matrix by transposing the arrays of a whole-graph CSC matrix (see transpose_CSC).
+         * 
+         * @param n The number of nodes in the graph.
+         * @param NNZ The number of non-zero elements in the graph.
+         * @param COL_PTR The column pointer array (len = n + 1).
+         * @param ROW_INDEX The row index array (len = NNZ).
+         * @param OUT_DEGREE The out degree array (len = n).
+         * @param num_null_cols The number of null columns.
+         * @param null_cols The indexes of the null columns.
+         * @param cores The number of cores to use for parallelization.
+         */
+        CSR_Matrix(long n, long NNZ, const long *COL_PTR, const long *ROW_INDEX, const long *OUT_DEGREE,
+                   long num_null_cols, const long *null_cols, int cores) : n(n), NNZ(NNZ), num_null_cols(num_null_cols) {
+            transpose_CSC(n, NNZ, COL_PTR, ROW_INDEX, ROW_PTR, COL_INDEX, cores);
+            this->OUT_DEGREE.assign(OUT_DEGREE, OUT_DEGREE + n);
+            indexes_null_cols.assign(null_cols, null_cols + num_null_cols);
+        }
+
+
+        /**
+         * @brief Prints all the matrix information.
+         * 
+         * @param max_el The maximum number of elements to print. Defaults to 20.
+         */
+        void print_info(int max_el = 20) {
+            std::cout << "Nodes: " << n << std::endl;
+            std::cout << "Edges: " << NNZ << std::endl;
+
+            std::cout << "Column index: ";
+            for (long i = 0; i < std::min<long>(max_el, NNZ); i++) {
+                std::cout << COL_INDEX[i] << " ";
+            }
+            std::cout << std::endl;
+
+            std::cout << "Row pointer: ";
+            for (long i = 0; i < std::min<long>(max_el, n + 1); i++) {
+                std::cout << ROW_PTR[i] << " ";
+            }
+            std::cout << std::endl;
+
+            std::cout << "Out degree: ";
+            for (long i = 0; i < std::min<long>(max_el, n); i++) {
+                std::cout << OUT_DEGREE[i] << " ";
+            }
+            std::cout << std::endl;
+
+            std::cout << "Null columns: " << num_null_cols << std::endl;
+            std::cout << std::endl;
+        }
+    };
+
+
+    /**
+     * @struct Compact_CSR_Matrix
+     * @brief A CSR_Matrix whose indexes are stored with the given unsigned integer type.
+     * 
+     * With 32-bit indexes the matrix takes half the memory, and the multiplication half the bandwidth, of a CSR_Matrix;
+     * they can be used when both the number of nodes and the number of edges are below 2^32 (see fits_32_bit).
+     */
+    template <typename Index>
+    struct Compact_CSR_Matrix {
+        long n, NNZ, num_null_cols;
+        std::vector<Index> COL_INDEX;         // len = NNZ, sources of the in-edges
+        std::vector<Index> ROW_PTR;           // len = n + 1
+        std::vector<Index> OUT_DEGREE;        // len = n
+        std::vector<Index> indexes_null_cols; // len = num_null_cols
+
+
+        /**
+         * @brief Builds the compact matrix by narrowing the arrays of a CSR_Matrix.
+         * 
+         * @param M The matrix, whose indexes must fit in Index.
+         * @param cores The number of cores to use for parallelization.
+         */
+        Compact_CSR_Matrix(const CSR_Matrix *M, int cores) : n(M->n), NNZ(M->NNZ), num_null_cols(M->num_null_cols) {
+            check_width();
+
+            COL_INDEX.resize(NNZ);
+            ROW_PTR.resize(n + 1);
+            OUT_DEGREE.resize(n);
+
+            #pragma omp parallel for num_threads(cores) schedule(static)
+            for (long j = 0; j < NNZ; j++) {
+                COL_INDEX[j] = M->COL_INDEX[j];
+            }
+
+            #pragma omp parallel for num_threads(cores) schedule(static)
+            for (long r = 0; r < n; r++) {
+                ROW_PTR[r] = M->ROW_PTR[r];
+                OUT_DEGREE[r] = M->OUT_DEGREE[r];
+            }
+            ROW_PTR[n] = M->ROW_PTR[n];
+
+            indexes_null_cols.assign(M->indexes_null_cols.begin(), M->indexes_null_cols.end());
+        }
+
+
+        /**
+         * @brief Builds the compact matrix by transposing the arrays of a whole-graph CSC matrix, without going
+         * through a CSR_Matrix.
+         * 
+         * Only the row pointers are transposed with 64-bit indexes, the sources of the in-edges are written as Index.
+         * 
+         * @param n The number of nodes in the graph, which with NNZ must fit in Index.
+         * @param NNZ The number of non-zero elements in the graph.
+         * @param COL_PTR The column pointer array (len = n + 1).
+         * @param ROW_INDEX The row index array (len = NNZ).
+         * @param OUT_DEGREE The out degree array (len = n).
+         * @param num_null_cols The number of null columns.
+         * @param null_cols The indexes of the null columns.
+         * @param cores The number of cores to use for parallelization.
+         */
+        Compact_CSR_Matrix(long n, long NNZ, const long *COL_PTR, const long *ROW_INDEX, const long *OUT_DEGREE,
+                           long num_null_cols, const long *null_cols, int cores) : n(n), NNZ(NNZ), num_null_cols(num_null_cols) {
+            check_width();
+
+            std::vector<long> row_ptr;
+            transpose_CSC(n, NNZ, COL_PTR, ROW_INDEX, row_ptr, COL_INDEX, cores);
+
+            ROW_PTR.resize(n + 1);
+            this->OUT_DEGREE.resize(n);
+
+            #pragma omp parallel for num_threads(cores) schedule(static)
+            for (long r = 0; r < n; r++) {
+                ROW_PTR[r] = row_ptr[r];
+                this->OUT_DEGREE[r] = OUT_DEGREE[r];
+            }
+            ROW_PTR[n] = row_ptr[n];
+
+            indexes_null_cols.assign(null_cols, null_cols + num_null_cols);
+        }
+
+
+        /**
+         * @brief Exits if the number of nodes or of edges does not fit in Index.
+         */
+        void check_width() const {
+            if ((unsigned long)std::max(n, NNZ) > (unsigned long)std::numeric_limits<Index>::max()) {
+                std::cout << "The graph is too large for " << 8 * sizeof(Index) << "-bit indexes" << std::endl;
+                exit(1);
+            }
+        }
+    };
+
+
+    /**
+     * @brief Checks whether the indexes of a graph with the given size fit in 32 bits.
+     */
+    inline bool fits_32_bit(long n, long NNZ) {
+        return std::max(n, NNZ) <= (long)std::numeric_limits<uint32_t>::max();
+    }
+
+
+    /**
+     * @struct Compact_Graph
+     * @brief A transposed matrix with the index width chosen when it was loaded: exactly one of the two is set.
+     */
+    struct Compact_Graph {
+        Compact_CSR_Matrix<uint32_t> *narrow = nullptr;  // 32-bit indexes
+        Compact_CSR_Matrix<uint64_t> *wide = nullptr;    // 64-bit indexes
+
+        Compact_Graph() = default;
+        Compact_Graph(const Compact_Graph&) = delete;
+        Compact_Graph& operator=(const Compact_Graph&) = delete;
+
+        ~Compact_Graph() {
+            delete narrow;
+            delete wide;
+        }
+
+        long n() const { return narrow != nullptr ? narrow->n : wide->n; }
+        long NNZ() const { return narrow != nullptr ? narrow->NNZ : wide->NNZ; }
+        int index_bits() const { return narrow != nullptr ? 32 : 64; }
+    };
+
+
     // ------------------ Load graph from file ------------------
 
     /**
@@ -198,12 +525,194 @@ namespace parallel {
 
 
     /**
-     * @brief Loads a graph from a file and returns its adjacency matrix in CSC format.
+     * @brief Splits a whole-graph CSC matrix into one row partition per core, with about the same number of edges each.
+     * 
+     * The columns are split into one block per core. A counting pass finds, for every block, the edges and the
+     * non-empty columns it gives to every partition, and their prefix sums over the blocks give every block its
+     * place in the arrays of every partition; a fill pass over the same blocks then copies the edges there. The
+     * partitions come out in column order without any atomic, and the whole split reads every edge twice, in
+     * O(n + NNZ log cores) time.
+     * 
+     * @param n The number of nodes in the graph.
+     * @param COL_PTR The column pointer array (len = n + 1).
+     * @param ROW_INDEX The row index array.
+     * @param OUT_DEGREE The out degree array (len = n).
+     * @param num_null_cols The number of null columns.
+     * @param indexes_null_cols The indexes of the null columns.
+     * @param cores The number of cores to use for parallelization.
+     * @return A vector of pointers to the CSC_Matrix objects representing the partitions of the graph.
+     */
+    std::vector<CSC_Matrix*> partition_CSC(long n, const long *COL_PTR, const long *ROW_INDEX, const long *OUT_DEGREE,
+                                           long num_null_cols, const long *indexes_null_cols, int cores) {
+        long NNZ = COL_PTR[n];
+
+        // Balance the partitions on the cumulative in-degree of the rows
+        std::vector<long> in_degree(n, 0), in_edges_before;
+
+        #pragma omp parallel for num_threads(cores)
+        for (long j = 0; j < NNZ; j++) {
+            #pragma omp atomic
+            in_degree[ROW_INDEX[j]]++;
+        }
+
+        edge_list::prefix_sum(in_degree, in_edges_before, cores);
+        std::vector<long> bounds = balanced_row_bounds(in_edges_before.data(), n, cores);
+        std::vector<long>().swap(in_degree);
+
+        auto owner = [&](long row) -> int {
+            return std::upper_bound(bounds.begin() + 1, bounds.end() - 1, row) - bounds.begin() - 1;
+        };
+
+        // Counting pass: edges[b*cores + c] and cols[b*cores + c] are the edges and the non-empty columns that block b
+        // of the columns gives to partition c
+        std::vector<long> edges(cores * cores, 0), cols(cores * cores, 0);
+
+        #pragma omp parallel for num_threads(cores) schedule(static, 1)
+        for (int b = 0; b < cores; b++) {
+            std::vector<long> last_col(cores, -1);
+
+            for (long i = n * b / cores; i < n * (b + 1) / cores; i++) {
+                for (long j = COL_PTR[i]; j < COL_PTR[i + 1]; j++) {
+                    int c = owner(ROW_INDEX[j]);
+                    edges[b*cores + c]++;
+                    if (last_col[c] != i) {
+                        last_col[c] = i;
+                        cols[b*cores + c]++;
+                    }
+                }
+            }
+        }
+
+        // Exclusive prefix sums over the blocks: the first edge and column of every block in every partition
+        std::vector<long> total_edges(cores), total_cols(cores);
+        for (int c = 0; c < cores; c++) {
+            long edge_sum = 0, col_sum = 0;
+            for (int b = 0; b < cores; b++) {
+                std::swap(edge_sum, edges[b*cores + c]);
+                std::swap(col_sum, cols[b*cores + c]);
+                edge_sum += edges[b*cores + c];
+                col_sum += cols[b*cores + c];
+            }
+            total_edges[c] = edge_sum;
+            total_cols[c] = col_sum;
+        }
+
+        std::vector<CSC_Matrix*> matrices(cores);
+
+        // Partition c is allocated, and so first-touched, by thread c, the thread that multiplies it in
+        // page_rank_iter_fused; the fill pass only writes into the pages
+        #pragma omp parallel for num_threads(cores) schedule(static, 1)
+        for (int c = 0; c < cores; c++) {
+            long first_row = bounds[c], last_row = bounds[c + 1];
+            CSC_Matrix *M = new CSC_Matrix(n, last_row - first_row, first_row);
+
+            M->NNZ = total_edges[c];
+            M->ROW_INDEX.resize(total_edges[c]);
+            M->COL_ID.resize(total_cols[c]);
+            M->COL_PTR.resize(total_cols[c] + 1);
+            M->COL_PTR[total_cols[c]] = total_edges[c];
+            M->OUT_DEGREE.assign(OUT_DEGREE + first_row, OUT_DEGREE + last_row);
+            matrices[c] = M;
+        }
+
+        // Fill pass: the partitions of every column are listed before its edges are copied, so that the edges of the
+        // column in every partition are contiguous even though its rows need not be sorted
+        #pragma omp parallel for num_threads(cores) schedule(static, 1)
+        for (int b = 0; b < cores; b++) {
+            std::vector<long> next_edge(edges.begin() + b*cores, edges.begin() + (b + 1)*cores);
+            std::vector<long> next_col(cols.begin() + b*cores, cols.begin() + (b + 1)*cores);
+            std::vector<char> seen(cores, 0);
+            std::vector<int> touched;
+
+            for (long i = n * b / cores; i < n * (b + 1) / cores; i++) {
+                for (long j = COL_PTR[i]; j < COL_PTR[i + 1]; j++) {
+                    int c = owner(ROW_INDEX[j]);
+                    if (!seen[c]) {
+                        seen[c] = 1;
+                        touched.push_back(c);
+                    }
+                }
+
+                for (int c : touched) {
+                    matrices[c]->COL_ID[next_col[c]] = i;
+                    matrices[c]->COL_PTR[next_col[c]] = next_edge[c];
+                    next_col[c]++;
+                }
+
+                for (long j = COL_PTR[i]; j < COL_PTR[i + 1]; j++) {
+                    long row = ROW_INDEX[j];
+                    int c = owner(row);
+                    matrices[c]->ROW_INDEX[next_edge[c]++] = row - bounds[c];
+                }
+
+                for (int c : touched) seen[c] = 0;
+                touched.clear();
+            }
+        }
+
+        matrices[0]->num_null_cols = num_null_cols;
+        matrices[0]->indexes_null_cols.assign(indexes_null_cols, indexes_null_cols + num_null_cols);
+
+        return matrices;
+    }
+
+
+    /**
+     * @brief Loads the row partitions of a graph from a binary snapshot, without parsing any text.
+     * 
+     * @param filename The name of the snapshot file.
+     * @param cores The number of cores to use for parallelization.
+     * @return A vector of pointers to the CSC_Matrix objects representing the partitions of the graph.
+     */
+    std::vector<CSC_Matrix*> load_graph_CSC_snapshot(const char *filename, int cores) {
+        snapshot::Mapped_CSC *S = snapshot::map_graph_CSC(filename);
+        std::cout << "Nodes: " << S->n << std::endl;
+        std::cout << "Edges: " << S->NNZ << std::endl;
+
+        std::vector<CSC_Matrix*> matrices = partition_CSC(S->n, S->COL_PTR, S->ROW_INDEX, S->OUT_DEGREE,
+                                                          S->num_null_cols, S->indexes_null_cols, cores);
+        delete S;
+
+        std::cout << "Graph loaded" << std::endl;
+
+        return matrices;
+    }
+
+
+    /**
+     * @brief Loads the row partitions of a graph from a text edge list, memory-mapped and parsed by all the cores.
+     * 
+     * The edges can be in any order.
+     * 
+     * @param filename The name of the graph file.
+     * @param cores The number of cores to use for parallelization.
+     * @param options Whether to sort the rows of every column and remove the repeated edges.
+     * @return A vector of pointers to the CSC_Matrix objects representing the partitions of the graph.
+     */
+    std::vector<CSC_Matrix*> load_graph_CSC_mmap(const char *filename, int cores, edge_list::Parse_Options options) {
+        std::cout << "Reading graph" << std::endl;
+        edge_list::CSC_Arrays A = edge_list::parse_CSC(filename, cores, options);
+        std::cout << "Nodes: " << A.n << std::endl;
+        std::cout << "Edges: " << A.NNZ << std::endl;
+
+        std::vector<CSC_Matrix*> matrices = partition_CSC(A.n, A.COL_PTR.data(), A.ROW_INDEX.data(), A.OUT_DEGREE.data(),
+                                                          A.indexes_null_cols.size(), A.indexes_null_cols.data(), cores);
+
+        std::cout << "Graph loaded" << std::endl;
+
+        return matrices;
+    }
+
+
+    /**
+     * @brief Loads a graph from a file reading it with an ifstream, one edge at a time.
+     * 
+     * This is the original loader, kept as a reference for load_graph_CSC. The file must be sorted by FromNodeId.
      * 
      * @param filename The name of the graph file.
      * @return A pointer to the CSC_Matrix object representing the graph.
      */
-    std::vector<CSC_Matrix*> load_graph_CSC(const char *filename, int cores) {
+    std::vector<CSC_Matrix*> load_graph_CSC_stream(const char *filename, int cores) {
         std::ifstream file(filename);
 
         // Store the graph adjacency matrix in CSC format
@@ -224,16 +733,16 @@ namespace parallel {
             std::vector<CSC_Matrix*> matrices(cores);
             for (int i = 0; i < cores; i++) {
                 if (i != cores - 1) {
-                    matrices[i] = new CSC_Matrix(n, m);
+                    matrices[i] = new CSC_Matrix(n, m, i*m);
                 } else {
-                    matrices[i] = new CSC_Matrix(n, n - m*(cores-1));
+                    matrices[i] = new CSC_Matrix(n, n - m*(cores-1), i*m);
                 }
             }
 
             // Read the graph
             std::string from, to;
             long from_node_id, to_node_id;
-            long i = 0, sum_rows = 0, col_els = 0;
+            long i = 0, col_els = 0;
             std::vector<long> indexes_null_cols, out_degree(n, 0);
 
             std::cout << "Reading graph" << std::endl;
@@ -282,7 +791,8 @@ namespace parallel {
             (*matrices[0]).indexes_null_cols = indexes_null_cols;
             
             for (int i = 0; i < cores; i++) {
-                (*matrices[i]).OUT_DEGREE = out_degree;
+                long first_row = (*matrices[i]).first_row;
+                (*matrices[i]).OUT_DEGREE.assign(out_degree.begin() + first_row, out_degree.begin() + first_row + (*matrices[i]).m);
             }
 
             return matrices;
@@ -293,4 +803,106 @@ namespace parallel {
         }
     }
 
-}
\ No newline at end of file
+
+    /**
+     * @brief Loads a graph from a file and returns its adjacency matrix in CSC format.
+     * 
+     * Binary snapshots (see csc_snapshot.cpp) are mapped, text edge lists are parsed in parallel by load_graph_CSC_mmap.
+     * 
+     * @param filename The name of the graph file.
+     * @param cores The number of cores to use for parallelization.
+     * @param options Whether to sort the rows of every column and remove the repeated edges. Ignored for snapshots.
+     * @return A vector of pointers to the CSC_Matrix objects representing the partitions of the graph.
+     */
+    std::vector<CSC_Matrix*> load_graph_CSC(const char *filename, int cores, edge_list::Parse_Options options = edge_list::Parse_Options()) {
+        if (snapshot::is_snapshot(filename)) {
+            return load_graph_CSC_snapshot(filename, cores);
+        }
+
+        return load_graph_CSC_mmap(filename, cores, options);
+    }
+
+
+    /**
+     * @brief Loads a graph from a file and returns its transposed adjacency matrix in CSR format.
+     * 
+     * @param filename The name of the graph file, either an edge list or a binary snapshot.
+     * @param cores The number of cores to use for parallelization.
+     * @param options Whether to sort the rows of every column and remove the repeated edges. Ignored for snapshots.
+     * @return A pointer to the CSR_Matrix object representing the graph.
+     */
+    CSR_Matrix* load_graph_CSR(const char *filename, int cores, edge_list::Parse_Options options = edge_list::Parse_Options()) {
+        CSR_Matrix *M;
+
+        if (snapshot::is_snapshot(filename)) {
+            snapshot::Mapped_CSC *S = snapshot::map_graph_CSC(filename);
+            M = new CSR_Matrix(S->n, S->NNZ, S->COL_PTR, S->ROW_INDEX, S->OUT_DEGREE, S->num_null_cols, S->indexes_null_cols, cores);
+            delete S;
+        } else {
+            std::cout << "Reading graph" << std::endl;
+            edge_list::CSC_Arrays A = edge_list::parse_CSC(filename, cores, options);
+            M = new CSR_Matrix(A.n, A.NNZ, A.COL_PTR.data(), A.ROW_INDEX.data(), A.OUT_DEGREE.data(),
+                               A.indexes_null_cols.size(), A.indexes_null_cols.data(), cores);
+        }
+
+        std::cout << "Graph loaded" << std::endl;
+
+        return M;
+    }
+
+
+    /**
+     * @brief Builds a Compact_Graph of the given width from the arrays of a whole-graph CSC matrix.
+     */
+    Compact_Graph* compact_graph(long n, long NNZ, const long *COL_PTR, const long *ROW_INDEX, const long *OUT_DEGREE,
+                                 long num_null_cols, const long *null_cols, int index_bits, int cores) {
+        Compact_Graph *G = new Compact_Graph();
+        if (index_bits == 0) index_bits = fits_32_bit(n, NNZ) ? 32 : 64;
+
+        if (index_bits == 32) {
+            G->narrow = new Compact_CSR_Matrix<uint32_t>(n, NNZ, COL_PTR, ROW_INDEX, OUT_DEGREE, num_null_cols, null_cols, cores);
+        } else {
+            G->wide = new Compact_CSR_Matrix<uint64_t>(n, NNZ, COL_PTR, ROW_INDEX, OUT_DEGREE, num_null_cols, null_cols, cores);
+        }
+
+        return G;
+    }
+
+
+    /**
+     * @brief Loads a graph from a file and returns its transposed adjacency matrix with compact indexes.
+     * 
+     * The matrix is built directly from the parsed or mapped arrays, so the 64-bit CSR_Matrix is never materialized.
+     * 
+     * @param filename The name of the graph file, either an edge list or a binary snapshot.
+     * @param cores The number of cores to use for parallelization.
+     * @param index_bits The width of the indexes, 32 or 64. Defaults to 0, the narrowest that fits the graph.
+     * @param options Whether to sort the rows of every column and remove the repeated edges. Ignored for snapshots.
+     * @return A pointer to the Compact_Graph representing the graph.
+     */
+    Compact_Graph* load_graph_compact(const char *filename, int cores, int index_bits = 0,
+                                      edge_list::Parse_Options options = edge_list::Parse_Options()) {
+        if (index_bits != 0 && index_bits != 32 && index_bits != 64) {
+            std::cout << "Unsupported index width: " << index_bits << std::endl;
+            exit(1);
+        }
+
+        Compact_Graph *G;
+
+        if (snapshot::is_snapshot(filename)) {
+            snapshot::Mapped_CSC *S = snapshot::map_graph_CSC(filename);
+            G = compact_graph(S->n, S->NNZ, S->COL_PTR, S->ROW_INDEX, S->OUT_DEGREE, S->num_null_cols, S->indexes_null_cols,
+                              index_bits, cores);
+            delete S;
+        } else {
+            std::cout << "Reading graph" << std::endl;
+            edge_list::CSC_Arrays A = edge_list::parse_CSC(filename, cores, options);
+            G = compact_graph(A.n, A.NNZ, A.COL_PTR.data(), A.ROW_INDEX.data(), A.OUT_DEGREE.data(),
+                              A.indexes_null_cols.size(), A.indexes_null_cols.data(), index_bits, cores);
+        }
+
+        std::cout << "Graph loaded with " << G->index_bits() << "-bit indexes" << std::endl;
+
+        return G;
+    }
+}
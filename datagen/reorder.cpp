@@ -0,0 +1,349 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+#include "seq_csc_matrix.cpp"
+
+/**
+ * @namespace reorder
+ * @brief Contains the vertex orderings that improve the locality of the Page Rank multiplication, and the functions
+ * to relabel a matrix and to map the results back to the original ids.
+ *
+ * Every ordering returns a Permutation: new_id[u] is the position of the original node u in the new order, and
+ * old_id is its inverse.
+ */
+namespace reorder {
+
+    /**
+     * @brief The available vertex orderings.
+     */
+    enum class Ordering {
+        ORIGINAL,   // The ids of the input file
+        DEGREE,     // Decreasing total degree, so the hubs share the first cache lines
+        RCM,        // Reverse Cuthill-McKee on the undirected graph, which reduces the bandwidth of the matrix
+        COMMUNITY   // Rabbit-style: communities found by incremental aggregation, laid out contiguously
+    };
+
+    const char* ordering_name(Ordering ordering) {
+        switch (ordering) {
+            case Ordering::DEGREE: return "degree";
+            case Ordering::RCM: return "rcm";
+            case Ordering::COMMUNITY: return "community";
+            default: return "original";
+        }
+    }
+
+
+    /**
+     * @struct Permutation
+     * @brief A relabelling of the nodes of a graph.
+     */
+    struct Permutation {
+        std::vector<long> new_id;  // len = n, new_id[original id] = new id
+        std::vector<long> old_id;  // len = n, old_id[new id] = original id
+
+
+        /**
+         * @brief Builds the permutation from the list of the original ids in the new order.
+         */
+        explicit Permutation(std::vector<long> &&order) : old_id(std::move(order)) {
+            new_id.resize(old_id.size());
+            for (long i = 0; i < (long)old_id.size(); i++) {
+                new_id[old_id[i]] = i;
+            }
+        }
+
+
+        /**
+         * @brief Maps a vector indexed by the new ids back to the original ids.
+         *
+         * @param x The vector in the new order (len = n).
+         * @return A pointer to the vector in the original order.
+         */
+        std::vector<double>* to_original(const std::vector<double> &x) const {
+            std::vector<double> *original = new std::vector<double>(x.size());
+            for (long u = 0; u < (long)x.size(); u++) {
+                (*original)[u] = x[new_id[u]];
+            }
+
+            return original;
+        }
+    };
+
+
+    // ------------------ Undirected graph ------------------
+
+    /**
+     * @brief Builds the undirected adjacency (out-edges and in-edges) of a matrix in CSR form, without self loops.
+     *
+     * @param M The matrix, either a CSC_Matrix or a snapshot::Mapped_CSC.
+     * @param ptr Receives the offsets of the neighbours of every node (len = n + 1).
+     * @param adj Receives the neighbours.
+     */
+    template <typename Matrix>
+    void undirected_adjacency(Matrix *M, std::vector<long> &ptr, std::vector<long> &adj) {
+        ptr.assign(M->n + 1, 0);
+        for (long u = 0; u < M->n; u++) {
+            for (long j = M->COL_PTR[u]; j < M->COL_PTR[u + 1]; j++) {
+                long v = M->ROW_INDEX[j];
+                if (u == v) continue;
+                ptr[u + 1]++;
+                ptr[v + 1]++;
+            }
+        }
+        for (long u = 0; u < M->n; u++) {
+            ptr[u + 1] += ptr[u];
+        }
+
+        adj.resize(ptr[M->n]);
+        std::vector<long> cursor(ptr.begin(), ptr.end() - 1);
+        for (long u = 0; u < M->n; u++) {
+            for (long j = M->COL_PTR[u]; j < M->COL_PTR[u + 1]; j++) {
+                long v = M->ROW_INDEX[j];
+                if (u == v) continue;
+                adj[cursor[u]++] = v;
+                adj[cursor[v]++] = u;
+            }
+        }
+    }
+
+
+    // ------------------ Orderings ------------------
+
+    /**
+     * @brief Orders the nodes by decreasing total degree, keeping the original order between equal degrees.
+     *
+     * @param M The matrix, either a CSC_Matrix or a snapshot::Mapped_CSC.
+     * @return The permutation.
+     */
+    template <typename Matrix>
+    Permutation degree_order(Matrix *M) {
+        std::vector<long> degree(M->n, 0);
+        for (long u = 0; u < M->n; u++) {
+            degree[u] += M->OUT_DEGREE[u];
+        }
+        for (long j = 0; j < M->NNZ; j++) {
+            degree[M->ROW_INDEX[j]]++;
+        }
+
+        std::vector<long> order(M->n);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](long a, long b) { return degree[a] > degree[b]; });
+
+        return Permutation(std::move(order));
+    }
+
+
+    /**
+     * @brief Orders the nodes with the Reverse Cuthill-McKee algorithm on the undirected graph.
+     *
+     * Every connected component is visited breadth first from a node of minimum degree, enqueueing the neighbours
+     * by increasing degree, and the final order is reversed.
+     *
+     * @param M The matrix, either a CSC_Matrix or a snapshot::Mapped_CSC.
+     * @return The permutation.
+     */
+    template <typename Matrix>
+    Permutation rcm_order(Matrix *M) {
+        long n = M->n;
+        std::vector<long> ptr, adj;
+        undirected_adjacency(M, ptr, adj);
+
+        auto degree = [&](long u) { return ptr[u + 1] - ptr[u]; };
+
+        std::vector<long> by_degree(n);
+        std::iota(by_degree.begin(), by_degree.end(), 0);
+        std::stable_sort(by_degree.begin(), by_degree.end(), [&](long a, long b) { return degree(a) < degree(b); });
+
+        std::vector<long> order;
+        order.reserve(n);
+        std::vector<char> visited(n, 0);
+
+        for (long start : by_degree) {
+            if (visited[start]) continue;
+
+            visited[start] = 1;
+            order.push_back(start);
+
+            for (size_t head = order.size() - 1; head < order.size(); head++) {
+                long u = order[head];
+                size_t first = order.size();
+
+                for (long j = ptr[u]; j < ptr[u + 1]; j++) {
+                    long v = adj[j];
+                    if (!visited[v]) {
+                        visited[v] = 1;
+                        order.push_back(v);
+                    }
+                }
+
+                std::stable_sort(order.begin() + first, order.end(), [&](long a, long b) { return degree(a) < degree(b); });
+            }
+        }
+
+        std::reverse(order.begin(), order.end());
+        return Permutation(std::move(order));
+    }
+
+
+    /**
+     * @brief Orders the nodes by communities, in the style of the Rabbit order.
+     *
+     * The nodes are visited by increasing degree and each one is merged into the neighbouring community with the
+     * largest positive modularity gain, building a dendrogram of merges. The order is then a depth-first visit of the
+     * dendrogram, so every community, and recursively every sub-community, gets a contiguous range of ids.
+     *
+     * @param M The matrix, either a CSC_Matrix or a snapshot::Mapped_CSC.
+     * @return The permutation.
+     */
+    template <typename Matrix>
+    Permutation community_order(Matrix *M) {
+        long n = M->n;
+        std::vector<long> ptr, adj;
+        undirected_adjacency(M, ptr, adj);
+        double total = std::max<double>(adj.size(), 1);   // Twice the number of undirected edges
+
+        // Every community is represented by one of its nodes, found with a union-find
+        std::vector<long> parent(n), members(n);
+        std::iota(parent.begin(), parent.end(), 0);
+        auto find = [&](long u) {
+            while (parent[u] != u) {
+                parent[u] = parent[parent[u]];
+                u = parent[u];
+            }
+            return u;
+        };
+
+        // The edges of a community are the edges of its members, kept as a list of the merged nodes
+        std::vector<double> strength(n);
+        std::vector<std::vector<long>> merged(n), children(n);
+        for (long u = 0; u < n; u++) {
+            strength[u] = ptr[u + 1] - ptr[u];
+            merged[u].push_back(u);
+        }
+
+        std::vector<long> by_degree(n);
+        std::iota(by_degree.begin(), by_degree.end(), 0);
+        std::stable_sort(by_degree.begin(), by_degree.end(), [&](long a, long b) { return strength[a] < strength[b]; });
+
+        std::vector<double> weight(n, 0);
+        std::vector<long> touched;
+
+        for (long u : by_degree) {
+            // Edge weight from the community of u to every neighbouring community
+            for (long w : merged[u]) {
+                for (long j = ptr[w]; j < ptr[w + 1]; j++) {
+                    long c = find(adj[j]);
+                    if (c == u) continue;
+                    if (weight[c] == 0) touched.push_back(c);
+                    weight[c] += 1;
+                }
+            }
+
+            long best = -1;
+            double best_gain = 0;
+            for (long c : touched) {
+                double gain = weight[c] / total - strength[u] * strength[c] / (total * total);
+                if (gain > best_gain) {
+                    best_gain = gain;
+                    best = c;
+                }
+                weight[c] = 0;
+            }
+            touched.clear();
+
+            if (best < 0) continue;
+
+            // Merge the community of u into the best one, appending the shorter list of nodes to the longer so that
+            // every node is copied O(log n) times
+            parent[u] = best;
+            strength[best] += strength[u];
+            if (merged[best].size() < merged[u].size()) std::swap(merged[best], merged[u]);
+            merged[best].insert(merged[best].end(), merged[u].begin(), merged[u].end());
+            std::vector<long>().swap(merged[u]);
+            children[best].push_back(u);
+        }
+
+        // Depth-first visit of the dendrogram from every top-level community
+        std::vector<long> order, stack;
+        order.reserve(n);
+        for (long root = 0; root < n; root++) {
+            if (parent[root] != root) continue;
+
+            stack.push_back(root);
+            while (!stack.empty()) {
+                long u = stack.back();
+                stack.pop_back();
+                order.push_back(u);
+
+                for (auto it = children[u].rbegin(); it != children[u].rend(); it++) {
+                    stack.push_back(*it);
+                }
+            }
+        }
+
+        return Permutation(std::move(order));
+    }
+
+
+    /**
+     * @brief Computes the given ordering of a matrix.
+     *
+     * @param M The matrix, either a CSC_Matrix or a snapshot::Mapped_CSC.
+     * @param ordering The ordering.
+     * @return The permutation.
+     */
+    template <typename Matrix>
+    Permutation compute(Matrix *M, Ordering ordering) {
+        switch (ordering) {
+            case Ordering::DEGREE: return degree_order(M);
+            case Ordering::RCM: return rcm_order(M);
+            case Ordering::COMMUNITY: return community_order(M);
+            default: {
+                std::vector<long> order(M->n);
+                std::iota(order.begin(), order.end(), 0);
+                return Permutation(std::move(order));
+            }
+        }
+    }
+
+
+    // ------------------ Relabelling ------------------
+
+    /**
+     * @brief Builds the matrix of the graph with the nodes relabelled by a permutation.
+     *
+     * The rows of every column are sorted, so the multiplication writes the output in increasing order.
+     *
+     * @param M The matrix, either a CSC_Matrix or a snapshot::Mapped_CSC.
+     * @param P The permutation.
+     * @return A pointer to the relabelled matrix.
+     */
+    template <typename Matrix>
+    sequential::CSC_Matrix* apply(Matrix *M, const Permutation &P) {
+        sequential::CSC_Matrix *R = new sequential::CSC_Matrix(M->n, M->NNZ);
+
+        long k = 0;
+        for (long i = 0; i < M->n; i++) {
+            long u = P.old_id[i];
+            R->COL_PTR[i] = k;
+
+            for (long j = M->COL_PTR[u]; j < M->COL_PTR[u + 1]; j++) {
+                R->ROW_INDEX[k++] = P.new_id[M->ROW_INDEX[j]];
+            }
+            std::sort(R->ROW_INDEX.begin() + R->COL_PTR[i], R->ROW_INDEX.begin() + k);
+
+            R->OUT_DEGREE[i] = M->OUT_DEGREE[u];
+            if (R->OUT_DEGREE[i] == 0) {
+                R->indexes_null_cols.push_back(i);
+            }
+        }
+        R->COL_PTR[M->n] = k;
+        R->num_null_cols = R->indexes_null_cols.size();
+
+        return R;
+    }
+}
@@ -1,3 +1,5 @@
+#pragma once
+
 #include <iostream>
 #include <fstream>
 #include <vector>
@@ -8,6 +10,9 @@
 #include <cmath>
 #include <numeric>
 
+#include "csc_snapshot.cpp"
+#include "edge_list_parser.cpp"
+
 /**
  * @namespace sequential
  * @brief Contains functions and data structures for sequential graph processing.
@@ -34,13 +39,27 @@ namespace sequential {
          * @param n The number of nodes in the graph.
          * @param NNZ The number of non-zero elements in the graph.
          */
-        CSC_Matrix(long n, long NNZ) : n(n), NNZ(NNZ) {
+        CSC_Matrix(long n, long NNZ) : n(n), NNZ(NNZ), num_null_cols(0) {
             ROW_INDEX.resize(NNZ);
             COL_PTR.resize(n + 1);
             OUT_DEGREE.resize(n);
         }
 
 
+        /**
+         * @brief Initializes a CSC_Matrix object taking ownership of the arrays built by the edge list parser.
+         * 
+         * @param A The parsed CSC arrays.
+         */
+        CSC_Matrix(edge_list::CSC_Arrays &&A) : n(A.n), NNZ(A.NNZ) {
+            ROW_INDEX = std::move(A.ROW_INDEX);
+            COL_PTR = std::move(A.COL_PTR);
+            OUT_DEGREE = std::move(A.OUT_DEGREE);
+            indexes_null_cols = std::move(A.indexes_null_cols);
+            num_null_cols = indexes_null_cols.size();
+        }
+
+
         /**
          * @brief Calculates the value of the element in position (i, j) of the matrix.
          * 
@@ -124,6 +143,58 @@ namespace sequential {
     };
 
 
+    // ------------------ Transposed matrix struct ------------------
+
+    /**
+     * @struct CSR_Matrix
+     * @brief Represents a graph adjacency matrix in Compressed Sparse Row (CSR) format, i.e. the in-edges of every node.
+     */
+    struct CSR_Matrix {
+        long n, NNZ, num_null_cols;
+        std::vector<long> COL_INDEX;         // len = NNZ, sources of the in-edges
+        std::vector<long> ROW_PTR;           // len = n + 1
+        std::vector<long> OUT_DEGREE;        // len = n
+        std::vector<long> indexes_null_cols; // len = num_null_cols
+
+
+        /**
+         * @brief Builds the CSR matrix by transposing a CSC matrix with a counting sort on the rows.
+         * 
+         * The columns are visited in order, so the sources of every row end up sorted.
+         * 
+         * @param M The matrix to transpose, either a CSC_Matrix or a snapshot::Mapped_CSC.
+         */
+        template <typename Matrix>
+        explicit CSR_Matrix(Matrix *M) : n(M->n), NNZ(M->NNZ), num_null_cols(M->num_null_cols) {
+            ROW_PTR.assign(n + 1, 0);
+            for (long j = 0; j < NNZ; j++) {
+                ROW_PTR[M->ROW_INDEX[j] + 1]++;
+            }
+            for (long r = 0; r < n; r++) {
+                ROW_PTR[r + 1] += ROW_PTR[r];
+            }
+
+            COL_INDEX.resize(NNZ);
+            std::vector<long> cursor(ROW_PTR.begin(), ROW_PTR.end() - 1);
+            for (long i = 0; i < n; i++) {
+                for (long j = M->COL_PTR[i]; j < M->COL_PTR[i + 1]; j++) {
+                    COL_INDEX[cursor[M->ROW_INDEX[j]]++] = i;
+                }
+            }
+
+            OUT_DEGREE.resize(n);
+            for (long i = 0; i < n; i++) {
+                OUT_DEGREE[i] = M->OUT_DEGREE[i];
+            }
+
+            indexes_null_cols.resize(num_null_cols);
+            for (long i = 0; i < num_null_cols; i++) {
+                indexes_null_cols[i] = M->indexes_null_cols[i];
+            }
+        }
+    };
+
+
     // ------------------ Load graph from file ------------------
 
     /**
@@ -156,12 +227,14 @@ namespace sequential {
 
 
     /**
-     * @brief Loads a graph from a file and returns its adjacency matrix in CSC format.
+     * @brief Loads a graph from a file reading it with an ifstream, one edge at a time.
+     * 
+     * This is the original loader, kept as a reference for load_graph_CSC. The file must be sorted by FromNodeId.
      * 
      * @param filename The name of the graph file.
      * @return A pointer to the CSC_Matrix object representing the graph.
      */
-    CSC_Matrix* load_graph_CSC(const char *filename) {
+    CSC_Matrix* load_graph_CSC_stream(const char *filename) {
         std::ifstream file(filename);
 
         // Store the graph adjacency matrix in CSC format
@@ -173,7 +246,7 @@ namespace sequential {
             std::cout << "Nodes: " << n << std::endl;
             std::cout << "Edges: " << NNZ << std::endl;
 
-            static CSC_Matrix M(n, NNZ);
+            CSC_Matrix &M = *new CSC_Matrix(n, NNZ);
 
             // Read the graph
             std::string from, to;
@@ -226,4 +299,36 @@ namespace sequential {
     }
 
 
+    /**
+     * @brief Loads a graph from a file and returns its adjacency matrix in CSC format.
+     * 
+     * The file is memory-mapped and parsed by edge_list::parse_CSC, in parallel when compiled with -fopenmp.
+     * The edges can be in any order.
+     * 
+     * @param filename The name of the graph file.
+     * @param threads The number of threads used by the parser. Defaults to 1.
+     * @param options Whether to sort the rows of every column and remove the repeated edges. Defaults to neither.
+     * @return A pointer to the CSC_Matrix object representing the graph.
+     */
+    CSC_Matrix* load_graph_CSC(const char *filename, int threads = 1, edge_list::Parse_Options options = edge_list::Parse_Options()) {
+        std::cout << "Reading graph" << std::endl;
+        CSC_Matrix *M = new CSC_Matrix(edge_list::parse_CSC(filename, threads, options));
+        std::cout << "Graph loaded" << std::endl;
+
+        return M;
+    }
+
+
+    /**
+     * @brief Saves a matrix to a binary snapshot file, which can later be mapped with snapshot::map_graph_CSC.
+     * 
+     * @param M The matrix to save.
+     * @param filename The name of the output file.
+     */
+    void save_graph_CSC(CSC_Matrix *M, const char *filename) {
+        snapshot::write(filename, M->n, M->NNZ, M->num_null_cols,
+                        M->COL_PTR.data(), M->ROW_INDEX.data(), M->OUT_DEGREE.data(), M->indexes_null_cols.data());
+    }
+
+
 }
\ No newline at end of file
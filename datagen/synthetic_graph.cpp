@@ -0,0 +1,363 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "csc_snapshot.cpp"
+
+/**
+ * @namespace synthetic
+ * @brief Contains the parallel generators of R-MAT, Kronecker and uniform random graphs, written either as a SNAP edge
+ * list or directly as a binary CSC snapshot.
+ *
+ * The edges are generated in blocks of BLOCK_EDGES, and every block draws from its own random stream, seeded from the
+ * seed of the graph and the index of the block. The graph is therefore the same whatever the number of threads, and
+ * a block can be generated again instead of being stored, so the snapshot is built in two passes over the edges
+ * without ever holding them in memory. As in the Graph500 generator, self loops and repeated edges are kept.
+ */
+namespace synthetic {
+
+    const long BLOCK_EDGES = 1 << 16;
+
+
+    /**
+     * @brief The model of the random graph.
+     */
+    enum class Model {
+        UNIFORM,    // Both ends of every edge uniform over the nodes (Erdos-Renyi)
+        RMAT,       // Recursive quadrants with probabilities a, b, c, d: node 0 is the largest hub
+        KRONECKER   // Stochastic Kronecker as in Graph500: R-MAT with noise on every level and scrambled node ids
+    };
+
+    /**
+     * @struct Generator_Options
+     * @brief The parameters of a random graph.
+     */
+    struct Generator_Options {
+        Model model = Model::KRONECKER;
+        int scale = 16;             // n = 2^scale, unless nodes is set
+        long nodes = 0;             // If set, the number of nodes of a uniform graph, which need not be a power of two
+        long edge_factor = 16;      // NNZ = edge_factor * n
+        double a = 0.57, b = 0.19, c = 0.19;  // The quadrant probabilities of R-MAT and Kronecker, d = 1 - a - b - c
+        double noise = 0.1;         // The noise on the probabilities of every level of Kronecker, at most 0.5
+        uint64_t seed = 1;
+        int threads = 1;
+    };
+
+
+    // ------------------ Random streams ------------------
+
+    /**
+     * @brief The SplitMix64 generator: fast, with 64-bit state, and good enough to derive independent streams from
+     * consecutive seeds.
+     */
+    struct Random {
+        uint64_t state;
+
+        explicit Random(uint64_t seed) : state(seed) {}
+
+        inline uint64_t next() {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        /**
+         * @brief Returns a double uniform in [0, 1), from the top 53 bits.
+         */
+        inline double uniform() {
+            return (next() >> 11) * (1.0 / 9007199254740992.0);
+        }
+
+        /**
+         * @brief Returns an integer uniform in [0, n), with a multiplication instead of a division.
+         */
+        inline long below(long n) {
+            return (long)(((unsigned __int128)next() * (uint64_t)n) >> 64);
+        }
+    };
+
+
+    /**
+     * @brief Returns the seed of the stream of a block, so that the streams of two blocks never overlap in practice.
+     */
+    inline uint64_t block_seed(uint64_t seed, long block) {
+        Random r(seed ^ (0xD1B54A32D192ED03ULL * (uint64_t)(block + 1)));
+        return r.next();
+    }
+
+
+    // ------------------ Generator ------------------
+
+    /**
+     * @struct Generator
+     * @brief The size of a random graph and the quadrant probabilities of every level, fixed from the options.
+     */
+    struct Generator {
+        Generator_Options options;
+        long n, NNZ, num_blocks;
+        std::vector<double> level_a, level_ab, level_abc;  // The cumulative quadrant probabilities of every level
+        uint64_t scramble_1, scramble_2;                    // The odd multipliers of the node id permutation
+
+
+        explicit Generator(const Generator_Options &o) : options(o) {
+            double d = 1 - o.a - o.b - o.c;
+            if (o.model != Model::UNIFORM && (o.a < 0 || o.b < 0 || o.c < 0 || d < 0)) {
+                std::cout << "Invalid quadrant probabilities" << std::endl;
+                exit(1);
+            }
+            if (o.scale < 1 || o.scale > 40 || o.edge_factor < 1 || o.noise < 0 || o.noise > 0.5 ||
+                (o.nodes != 0 && (o.model != Model::UNIFORM || o.nodes < 2))) {
+                std::cout << "Invalid graph parameters" << std::endl;
+                exit(1);
+            }
+
+            n = o.nodes != 0 ? o.nodes : 1L << o.scale;
+            NNZ = n * o.edge_factor;
+            num_blocks = (NNZ + BLOCK_EDGES - 1) / BLOCK_EDGES;
+
+            // Kronecker perturbs the probabilities of every level, keeping their sum (Seshadhri, Pinar and Kolda),
+            // which smooths the oscillations of the degree distribution of plain R-MAT
+            Random r(o.seed);
+            for (int level = 0; level < o.scale; level++) {
+                double a = o.a, b = o.b, c = o.c, dd = d;
+                if (o.model == Model::KRONECKER) {
+                    double mu = o.noise * (2 * r.uniform() - 1);
+                    double ad = a + dd;
+                    a -= 2 * mu * a / ad;
+                    dd -= 2 * mu * dd / ad;
+                    b += mu;
+                    c += mu;
+                }
+                double total = a + b + c + dd;
+                level_a.push_back(a / total);
+                level_ab.push_back((a + b) / total);
+                level_abc.push_back((a + b + c) / total);
+            }
+
+            scramble_1 = r.next() | 1;
+            scramble_2 = r.next() | 1;
+        }
+
+        /**
+         * @brief Maps a node id to its scrambled id, with a bijection of [0, 2^scale) made of multiplications by odd
+         * constants and xor-shifts, so that the hubs are spread over the ids without storing a permutation.
+         */
+        inline long scramble(uint64_t x) const {
+            const int s = options.scale;
+            const uint64_t mask = (1ULL << s) - 1;
+            x = (x * scramble_1) & mask;
+            x ^= x >> ((s + 1) / 2);
+            x = (x * scramble_2) & mask;
+            x ^= x >> ((s + 2) / 3);
+            return x;
+        }
+
+        /**
+         * @brief Draws an edge by descending the quadrants of the adjacency matrix, one bit of each end per level.
+         */
+        inline void rmat_edge(Random &r, long &from, long &to) const {
+            uint64_t i = 0, j = 0;
+            for (int level = 0; level < options.scale; level++) {
+                double u = r.uniform();
+                uint64_t bit = 1ULL << (options.scale - 1 - level);
+                if (u >= level_a[level]) {
+                    if (u < level_ab[level]) {
+                        j |= bit;
+                    } else if (u < level_abc[level]) {
+                        i |= bit;
+                    } else {
+                        i |= bit;
+                        j |= bit;
+                    }
+                }
+            }
+
+            from = i;
+            to = j;
+        }
+
+        /**
+         * @brief Calls visit(from, to) on every edge of a block, in order.
+         */
+        template <typename Visit>
+        void generate_block(long block, Visit visit) const {
+            Random r(block_seed(options.seed, block));
+            long first = block * BLOCK_EDGES, last = std::min(first + BLOCK_EDGES, NNZ);
+
+            for (long e = first; e < last; e++) {
+                long from, to;
+                if (options.model == Model::UNIFORM) {
+                    from = r.below(n);
+                    to = r.below(n);
+                } else {
+                    rmat_edge(r, from, to);
+                    if (options.model == Model::KRONECKER) {
+                        from = scramble(from);
+                        to = scramble(to);
+                    }
+                }
+                visit(from, to);
+            }
+        }
+    };
+
+
+    // ------------------ Output ------------------
+
+    /**
+     * @brief Appends the decimal digits of a non-negative number to a buffer.
+     */
+    inline void append_number(std::string &out, long x) {
+        char digits[24];
+        int len = 0;
+        do {
+            digits[len++] = '0' + x % 10;
+            x /= 10;
+        } while (x > 0);
+        while (len > 0) out.push_back(digits[--len]);
+    }
+
+
+    /**
+     * @brief Writes the graph as a SNAP edge list, with the "# Nodes: n Edges: NNZ" header expected by read_header.
+     *
+     * The blocks are formatted in parallel, a round of a few blocks per thread at a time, and written in order, so
+     * the memory stays small whatever the size of the graph. The edges are not sorted by source, which the loaders
+     * handle with their unsorted path.
+     *
+     * @param G The generator.
+     * @param filename The name of the output file.
+     */
+    void write_text(const Generator &G, const char *filename) {
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cout << "Unable to open file" << std::endl;
+            exit(1);
+        }
+
+        file << "# Synthetic graph (" << (G.options.model == Model::UNIFORM ? "uniform" : G.options.model == Model::RMAT ? "rmat" : "kronecker")
+             << ", scale " << G.options.scale << ", edge factor " << G.options.edge_factor << ", seed " << G.options.seed << ")\n";
+        file << "# Nodes: " << G.n << " Edges: " << G.NNZ << "\n";
+        file << "# FromNodeId\tToNodeId\n";
+
+        const int threads = G.options.threads;
+        const long round = 4L * threads;
+        std::vector<std::string> buffers(round);
+
+        for (long first = 0; first < G.num_blocks; first += round) {
+            long last = std::min(first + round, G.num_blocks);
+
+            #pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
+            for (long b = first; b < last; b++) {
+                std::string &out = buffers[b - first];
+                out.clear();
+                G.generate_block(b, [&](long from, long to) {
+                    append_number(out, from);
+                    out.push_back('\t');
+                    append_number(out, to);
+                    out.push_back('\n');
+                });
+            }
+
+            for (long b = first; b < last; b++) {
+                file.write(buffers[b - first].data(), buffers[b - first].size());
+            }
+        }
+
+        if (!file) {
+            std::cout << "Error while writing the edge list" << std::endl;
+            exit(1);
+        }
+    }
+
+
+    /**
+     * @brief Writes the graph directly as a binary CSC snapshot, which the loaders map instead of parsing.
+     *
+     * The file is sized and mapped first, and filled in place in two passes over the blocks: the first counts the out
+     * degrees, which give COL_PTR, and the second generates the blocks again and scatters the destination of every
+     * edge into its column. The edges of a column land in an order that depends on the threads, so every column is
+     * sorted at the end, which also makes the file the same whatever the number of threads. Only the out degrees
+     * and the column cursors are held in memory; ROW_INDEX lives in the mapping.
+     *
+     * @param G The generator.
+     * @param filename The name of the output file.
+     */
+    void write_snapshot(const Generator &G, const char *filename) {
+        const int threads = G.options.threads;
+        const long n = G.n;
+
+        // First pass: the out degrees
+        std::vector<long> OUT_DEGREE(n, 0);
+        #pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
+        for (long b = 0; b < G.num_blocks; b++) {
+            G.generate_block(b, [&](long from, long) {
+                __atomic_fetch_add(&OUT_DEGREE[from], 1, __ATOMIC_RELAXED);
+            });
+        }
+
+        std::vector<long> null_cols;
+        for (long i = 0; i < n; i++) {
+            if (OUT_DEGREE[i] == 0) null_cols.push_back(i);
+        }
+
+        snapshot::Header h = snapshot::make_header(n, G.NNZ, null_cols.size());
+
+        int fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0 || ftruncate(fd, h.file_size) != 0) {
+            std::cout << "Unable to open file" << std::endl;
+            exit(1);
+        }
+
+        char *base = static_cast<char*>(mmap(nullptr, h.file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+        close(fd);
+        if (base == MAP_FAILED) {
+            std::cout << "Unable to map file" << std::endl;
+            exit(1);
+        }
+
+        long *COL_PTR = reinterpret_cast<long*>(base + h.col_ptr_offset);
+        long *ROW_INDEX = reinterpret_cast<long*>(base + h.row_index_offset);
+        std::memcpy(base, &h, sizeof(h));
+        std::memcpy(base + h.out_degree_offset, OUT_DEGREE.data(), n * sizeof(long));
+        std::memcpy(base + h.null_cols_offset, null_cols.data(), null_cols.size() * sizeof(long));
+
+        COL_PTR[0] = 0;
+        for (long i = 0; i < n; i++) {
+            COL_PTR[i + 1] = COL_PTR[i] + OUT_DEGREE[i];
+        }
+
+        // Second pass: the destinations, with the out degrees reused as the cursors of the columns
+        std::copy(COL_PTR, COL_PTR + n, OUT_DEGREE.begin());
+        std::vector<long> &cursor = OUT_DEGREE;
+
+        #pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
+        for (long b = 0; b < G.num_blocks; b++) {
+            G.generate_block(b, [&](long from, long to) {
+                ROW_INDEX[__atomic_fetch_add(&cursor[from], 1, __ATOMIC_RELAXED)] = to;
+            });
+        }
+
+        #pragma omp parallel for num_threads(threads) schedule(dynamic, 4096)
+        for (long i = 0; i < n; i++) {
+            std::sort(ROW_INDEX + COL_PTR[i], ROW_INDEX + COL_PTR[i + 1]);
+        }
+
+        if (munmap(base, h.file_size) != 0) {
+            std::cout << "Error while writing the snapshot" << std::endl;
+            exit(1);
+        }
+    }
+}
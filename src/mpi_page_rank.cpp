@@ -0,0 +1,233 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <climits>
+#include <algorithm>
+
+#include <mpi.h>
+
+#include "../datagen/csc_shards.cpp"
+#include "par_page_rank.cpp"
+
+/**
+ * @namespace distributed
+ * @brief Contains the Page Rank algorithm over several MPI processes, each one owning a block of rows of the
+ * transposed matrix as the partitions of parallel::load_graph_CSC, and using OpenMP threads within the block.
+ *
+ * Every process keeps the contributions of all the nodes, and after every iteration the blocks of the new
+ * contributions are exchanged with an all-gather, while the norm and the dangling mass are combined with an
+ * all-reduce. The files must be compiled with mpicxx and run with mpirun.
+ */
+namespace distributed {
+
+    /**
+     * @struct Distributed_Matrix
+     * @brief The block of rows of the transposed matrix owned by a process.
+     */
+    struct Distributed_Matrix {
+        long n, NNZ;                  // The size of the whole graph
+        long first_row, rows;         // The block of this process
+        std::vector<long> ROW_PTR;    // len = rows + 1, offsets into COL_INDEX
+        std::vector<long> COL_INDEX;  // sources of the in-edges of the block
+        std::vector<long> OUT_DEGREE; // len = rows
+
+        MPI_Comm comm;
+        int rank, size;
+        std::vector<int> counts, displs;  // The rows and the first row of every process, for the all-gathers
+    };
+
+
+    /**
+     * @brief Loads the block of rows of the calling process from a text edge list or a snapshot.
+     *
+     * Every process reads the input twice: to count the degrees with shards::count_degrees, which takes the number
+     * of nodes from the header or the snapshot, and choose the blocks, balanced on rows plus in-edges with
+     * parallel::balanced_row_bounds, and to collect the in-edges of its own block. Only the block and
+     * the degree arrays are held in memory.
+     *
+     * @param filename The path to the file containing the graph.
+     * @param comm The communicator of the processes sharing the graph.
+     * @return A pointer to the block of the calling process.
+     */
+    Distributed_Matrix* load_graph(const char *filename, MPI_Comm comm = MPI_COMM_WORLD) {
+        Distributed_Matrix *M = new Distributed_Matrix();
+        M->comm = comm;
+        MPI_Comm_rank(comm, &M->rank);
+        MPI_Comm_size(comm, &M->size);
+
+        shards::Degree_Count D = shards::count_degrees(filename);
+        std::vector<long> &out_degree = D.out_degree, &in_degree = D.in_degree;
+        long n = D.n;
+        M->n = n;
+        M->NNZ = D.NNZ;
+
+        std::vector<long> in_edges_before(n + 1, 0);
+        for (long i = 0; i < n; i++) {
+            in_edges_before[i + 1] = in_edges_before[i] + in_degree[i];
+        }
+        std::vector<long> bounds = parallel::balanced_row_bounds(in_edges_before.data(), n, M->size);
+
+        M->counts.resize(M->size);
+        M->displs.resize(M->size);
+        for (int p = 0; p < M->size; p++) {
+            if (bounds[p + 1] - bounds[p] > INT_MAX) {
+                std::cout << "The blocks are too large for MPI: use more processes" << std::endl;
+                MPI_Abort(comm, 1);
+            }
+            M->counts[p] = bounds[p + 1] - bounds[p];
+            M->displs[p] = bounds[p];
+        }
+
+        M->first_row = bounds[M->rank];
+        M->rows = bounds[M->rank + 1] - M->first_row;
+        long last_row = M->first_row + M->rows;
+
+        M->OUT_DEGREE.assign(out_degree.begin() + M->first_row, out_degree.begin() + last_row);
+        M->ROW_PTR.resize(M->rows + 1);
+        for (long i = 0; i <= M->rows; i++) {
+            M->ROW_PTR[i] = in_edges_before[M->first_row + i] - in_edges_before[M->first_row];
+        }
+        std::vector<long>().swap(out_degree);
+        std::vector<long>().swap(in_degree);
+        std::vector<long>().swap(in_edges_before);
+
+        M->COL_INDEX.resize(M->ROW_PTR[M->rows]);
+        std::vector<long> cursor(M->ROW_PTR.begin(), M->ROW_PTR.end() - 1);
+        shards::for_each_edge(filename, [&](long from, long to) {
+            if (to >= M->first_row && to < last_row) {
+                M->COL_INDEX[cursor[to - M->first_row]++] = from;
+            }
+        });
+
+        for (long i = 0; i < M->rows; i++) {
+            std::sort(M->COL_INDEX.begin() + M->ROW_PTR[i], M->COL_INDEX.begin() + M->ROW_PTR[i + 1]);
+        }
+
+        return M;
+    }
+
+
+    /**
+     * @brief Performs a single iteration of the Page Rank algorithm on the block of a process.
+     *
+     * This is parallel::page_rank_iter_simd on the rows of the block: v, result and next_contrib point to the first
+     * row of the block, while contrib holds the contributions of all the nodes.
+     *
+     * @param M The block of the process.
+     * @param v The ranks of the block.
+     * @param result The vector where the new ranks of the block are written.
+     * @param contrib The contributions of all the nodes (len = n).
+     * @param next_contrib The vector where the contributions of the new ranks of the block are written.
+     * @param dangling The dangling mass of the whole graph.
+     * @param local_dangling Receives the dangling mass of the new ranks of the block.
+     * @param cores The number of cores to use for parallelization.
+     * @return The squared norm of the difference over the block.
+     */
+    double page_rank_iter_block(Distributed_Matrix *M, const double *v, double *result, const double *contrib,
+                                double *next_contrib, double dangling, double &local_dangling, int cores,
+                                const simd::Kernels &K = simd::active) {
+        const long chunk = 1024;
+        double base = 0.85*dangling/M->n + 0.15/M->n;
+        double norm = 0, next_dangling = 0;
+
+        #pragma omp parallel for num_threads(cores) schedule(dynamic, 1) reduction(+:norm, next_dangling)
+        for (long first = 0; first < M->rows; first += chunk) {
+            long last = std::min(first + chunk, M->rows);
+
+            for (long r = first; r < last; r++) {
+                result[r] = K.row_sum(M->COL_INDEX.data() + M->ROW_PTR[r], M->ROW_PTR[r + 1] - M->ROW_PTR[r], contrib);
+            }
+
+            norm += K.finalize(last - first, M->OUT_DEGREE.data() + first, v + first, result + first,
+                               next_contrib + first, base, next_dangling);
+        }
+
+        local_dangling = next_dangling;
+        return norm;
+    }
+
+
+    /**
+     * @brief Gathers the blocks of a vector from all the processes, in place.
+     *
+     * @param M The block of the calling process.
+     * @param x The vector (len = n), whose block of the calling process is up to date.
+     */
+    inline void all_gather_blocks(Distributed_Matrix *M, std::vector<double> &x) {
+        MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, x.data(), M->counts.data(), M->displs.data(), MPI_DOUBLE, M->comm);
+    }
+
+
+    /**
+     * @brief Performs the Page Rank algorithm over all the processes of the communicator of the matrix.
+     *
+     * It must be called by every process with the same options. The starting vector is chosen by the first process
+     * (from the checkpoint, the initial vector or at random) and broadcast, and the checkpoints are written by the
+     * first process. The iterates are the same as the ones of parallel::Page_Rank.
+     *
+     * @param M The block of the calling process, as returned by load_graph.
+     * @param cores The number of cores of every process.
+     * @param options The tolerance, the output for the number of iterations, the starting vector and the checkpoints.
+     *                The solver and the trace are ignored.
+     * @return A pointer to the final Page Rank vector, on every process.
+     */
+    std::vector<double>* Page_Rank(Distributed_Matrix *M, int cores, parallel::Page_Rank_Options options = parallel::Page_Rank_Options()) {
+        long n = M->n;
+
+        // parallel::starting_vector exits on a mismatch, which would leave the other processes waiting in the
+        // broadcast, so the first process checks the starting vector beforehand and aborts all of them
+        if (M->rank == 0) {
+            rank_file::Header h;
+            bool resume = options.checkpoint_file != nullptr && rank_file::exists(options.checkpoint_file);
+            if (resume ? !rank_file::read_header(options.checkpoint_file, h) || h.n != n
+                       : options.initial != nullptr && (long)options.initial->size() != n) {
+                std::cout << "The starting vector does not match the graph" << std::endl;
+                MPI_Abort(M->comm, 1);
+            }
+        }
+
+        int iterations = 0;
+        std::vector<double> *x = M->rank == 0 ? parallel::starting_vector(n, options, iterations) : new std::vector<double>(n);
+        MPI_Bcast(x->data(), n, MPI_DOUBLE, 0, M->comm);
+        MPI_Bcast(&iterations, 1, MPI_INT, 0, M->comm);
+
+        std::vector<double> v(x->begin() + M->first_row, x->begin() + M->first_row + M->rows), result(M->rows);
+        std::vector<double> contrib(n), next_contrib(n);
+
+        double partial[2] = {0, 0}, total[2];   // The squared norm and the dangling mass
+        partial[1] = parallel::prepare_contrib(M->rows, M->OUT_DEGREE.data(), v.data(), contrib.data() + M->first_row, cores);
+        all_gather_blocks(M, contrib);
+        MPI_Allreduce(&partial[1], &total[1], 1, MPI_DOUBLE, MPI_SUM, M->comm);
+        double dangling = total[1];
+
+        double norm = 1;
+        while (norm >= options.tolerance) {
+            partial[0] = page_rank_iter_block(M, v.data(), result.data(), contrib.data(), next_contrib.data() + M->first_row,
+                                              dangling, partial[1], cores);
+            all_gather_blocks(M, next_contrib);
+            MPI_Allreduce(partial, total, 2, MPI_DOUBLE, MPI_SUM, M->comm);
+
+            norm = sqrt(total[0]);
+            dangling = total[1];
+            iterations++;
+
+            std::swap(v, result);
+            std::swap(contrib, next_contrib);
+
+            if (options.checkpoint_file != nullptr && options.checkpoint_interval > 0 && iterations % options.checkpoint_interval == 0) {
+                std::copy(v.begin(), v.end(), x->begin() + M->first_row);
+                all_gather_blocks(M, *x);
+                if (M->rank == 0) parallel::checkpoint(options, *x, iterations);
+            }
+        }
+
+        if (M->rank == 0) parallel::finish_checkpoint(options);
+        if (options.iterations != nullptr) *options.iterations = iterations;
+
+        std::copy(v.begin(), v.end(), x->begin() + M->first_row);
+        all_gather_blocks(M, *x);
+        return x;
+    }
+}
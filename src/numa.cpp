@@ -0,0 +1,215 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <omp.h>
+
+/**
+ * @namespace numa
+ * @brief Contains the topology of the NUMA nodes read from sysfs, the pinning of the OpenMP threads to their CPUs and
+ * a report of where the threads run and the pages live.
+ *
+ * Only the kernel interfaces are used (sysfs, sched_setaffinity and get_mempolicy), so nothing needs to be linked and
+ * a machine without NUMA support is seen as a single node with all the online CPUs.
+ */
+namespace numa {
+
+    /**
+     * @struct Topology
+     * @brief The CPUs and the memory of every NUMA node.
+     */
+    struct Topology {
+        std::vector<std::vector<int>> cpus;  // The CPUs of every node
+        std::vector<long> memory_kb;         // The memory of every node
+
+        int nodes() const {
+            return cpus.size();
+        }
+    };
+
+
+    /**
+     * @brief Parses a sysfs CPU list such as "0-3,8,10-11".
+     */
+    std::vector<int> parse_cpu_list(const std::string &list) {
+        std::vector<int> cpus;
+        std::stringstream stream(list);
+        std::string range;
+
+        while (std::getline(stream, range, ',')) {
+            if (range.empty() || range == "\n") continue;
+            size_t dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; cpu++) {
+                cpus.push_back(cpu);
+            }
+        }
+
+        return cpus;
+    }
+
+
+    /**
+     * @brief Reads the NUMA nodes with CPUs from /sys/devices/system/node.
+     *
+     * @return The topology, with a single node holding the online CPUs when sysfs has no node.
+     */
+    Topology topology() {
+        Topology T;
+
+        for (int node = 0; ; node++) {
+            std::string dir = "/sys/devices/system/node/node" + std::to_string(node);
+            std::ifstream cpulist(dir + "/cpulist");
+            if (!cpulist.is_open()) {
+                if (node >= 64) break;
+                continue;   // Node ids can have holes
+            }
+
+            std::string list;
+            std::getline(cpulist, list);
+            std::vector<int> cpus = parse_cpu_list(list);
+            if (cpus.empty()) continue;   // Memory-only node
+
+            long memory = 0;
+            std::ifstream meminfo(dir + "/meminfo");
+            std::string line;
+            while (std::getline(meminfo, line)) {
+                size_t pos = line.find("MemTotal:");
+                if (pos != std::string::npos) {
+                    memory = std::stol(line.substr(pos + 9));
+                    break;
+                }
+            }
+
+            T.cpus.push_back(cpus);
+            T.memory_kb.push_back(memory);
+        }
+
+        if (T.cpus.empty()) {
+            long online = sysconf(_SC_NPROCESSORS_ONLN);
+            T.cpus.emplace_back();
+            for (int cpu = 0; cpu < online; cpu++) {
+                T.cpus[0].push_back(cpu);
+            }
+            T.memory_kb.push_back(sysconf(_SC_PHYS_PAGES) * (sysconf(_SC_PAGESIZE) / 1024));
+        }
+
+        return T;
+    }
+
+
+    /**
+     * @brief Assigns a CPU to every thread: the threads are split into one contiguous block per node, in proportion
+     * to the CPUs of the node, so that consecutive partitions share a node.
+     *
+     * @param T The topology.
+     * @param threads The number of threads.
+     * @return The CPU of every thread (len = threads). CPUs are reused when there are more threads than CPUs.
+     */
+    std::vector<int> placement(const Topology &T, int threads) {
+        std::vector<int> order;
+        for (const std::vector<int> &cpus : T.cpus) {
+            order.insert(order.end(), cpus.begin(), cpus.end());
+        }
+
+        std::vector<int> cpu(threads);
+        for (int t = 0; t < threads; t++) {
+            cpu[t] = order[(long)t * order.size() / threads % order.size()];
+        }
+
+        return cpu;
+    }
+
+
+    /**
+     * @brief Returns the node of a CPU, or -1 if it is not in the topology.
+     */
+    int node_of_cpu(const Topology &T, int cpu) {
+        for (int node = 0; node < T.nodes(); node++) {
+            for (int c : T.cpus[node]) {
+                if (c == cpu) return node;
+            }
+        }
+        return -1;
+    }
+
+
+    /**
+     * @brief Returns the node of the page holding the given address, or -1 if the kernel cannot tell.
+     *
+     * The page must have been touched, otherwise it has no node yet.
+     */
+    int node_of_page(const void *address) {
+        const unsigned long MPOL_F_NODE = 1, MPOL_F_ADDR = 2;
+        int node = -1;
+        if (syscall(SYS_get_mempolicy, &node, nullptr, 0, address, MPOL_F_NODE | MPOL_F_ADDR) != 0) {
+            return -1;
+        }
+        return node;
+    }
+
+
+    /**
+     * @brief Pins every thread of the OpenMP teams of the given size to its CPU of placement.
+     *
+     * The OpenMP runtime reuses the same threads for the next teams of the same size, so a loop with
+     * schedule(static, 1) over one partition per thread then always runs a partition on the same CPU. Calling this
+     * before loading the partitions makes every partition first-touched, and so allocated, on the node of its thread.
+     *
+     * @param cores The number of threads.
+     * @return The CPU of every thread.
+     */
+    std::vector<int> pin_threads(int cores) {
+        std::vector<int> cpu = placement(topology(), cores);
+
+        #pragma omp parallel num_threads(cores)
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu[omp_get_thread_num()], &set);
+            if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+                #pragma omp critical
+                std::cout << "Unable to pin thread " << omp_get_thread_num() << " to CPU " << cpu[omp_get_thread_num()] << std::endl;
+            }
+        }
+
+        return cpu;
+    }
+
+
+    /**
+     * @brief Prints the nodes, and the CPU and node where every thread of a team of the given size runs.
+     *
+     * @param cores The number of threads.
+     */
+    void print_topology(int cores) {
+        Topology T = topology();
+
+        std::cout << "NUMA nodes: " << T.nodes() << std::endl;
+        for (int node = 0; node < T.nodes(); node++) {
+            std::cout << "  node " << node << ": " << T.cpus[node].size() << " CPUs (";
+            for (size_t i = 0; i < T.cpus[node].size(); i++) {
+                std::cout << (i ? "," : "") << T.cpus[node][i];
+            }
+            std::cout << "), " << T.memory_kb[node] / 1024 << " MB" << std::endl;
+        }
+
+        std::vector<int> running(cores);
+        #pragma omp parallel num_threads(cores)
+        running[omp_get_thread_num()] = sched_getcpu();
+
+        std::cout << "Threads:";
+        for (int t = 0; t < cores; t++) {
+            std::cout << " " << t << "->cpu" << running[t] << "/node" << node_of_cpu(T, running[t]);
+        }
+        std::cout << std::endl;
+    }
+}
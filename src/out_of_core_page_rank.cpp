@@ -0,0 +1,213 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "../datagen/csc_shards.cpp"
+#include "par_page_rank.cpp"
+
+// ------------------ Out-of-core Page Rank ------------------
+// The power method on a graph split into shards by destination range (see datagen/csc_shards.cpp): only the rank
+// vectors stay in memory, and every iteration streams the shards from disk, reading the next one on a background
+// thread while the current one is computed.
+
+
+namespace parallel {
+
+    /**
+     * @class Shard_Stream
+     * @brief Reads the shards of a graph in a loop on a background thread, one shard ahead of the consumer.
+     *
+     * The shards are read into two buffers that alternate: while the consumer works on one, the thread fills the
+     * other. A graph with a single shard is read once and kept.
+     */
+    class Shard_Stream {
+    public:
+        explicit Shard_Stream(const shards::Sharded_Graph &G) : G(G) {
+            if (G.num_shards() == 1) {
+                shards::read_shard(G, 0, buffers[0]);
+                loaded = 1;
+            } else {
+                worker = std::thread(&Shard_Stream::read_ahead, this);
+            }
+        }
+
+        Shard_Stream(const Shard_Stream&) = delete;
+        Shard_Stream& operator=(const Shard_Stream&) = delete;
+
+        ~Shard_Stream() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stop = true;
+            }
+            changed.notify_all();
+            if (worker.joinable()) worker.join();
+        }
+
+
+        /**
+         * @brief Waits for the next shard, in the order 0, 1, ..., num_shards - 1, 0, 1, ...
+         */
+        const shards::Shard& acquire() {
+            if (G.num_shards() == 1) return buffers[0];
+
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&] { return loaded > consumed; });
+            return buffers[consumed % 2];
+        }
+
+        /**
+         * @brief Gives back the shard returned by acquire, so its buffer can be refilled.
+         */
+        void release() {
+            if (G.num_shards() == 1) return;
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                consumed++;
+            }
+            changed.notify_all();
+        }
+
+    private:
+        const shards::Sharded_Graph &G;
+        shards::Shard buffers[2];
+        std::thread worker;
+        std::mutex mutex;
+        std::condition_variable changed;
+        long loaded = 0, consumed = 0;  // The shards read and released since the start
+        bool stop = false;
+
+        void read_ahead() {
+            for (long next = 0; ; next++) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    changed.wait(lock, [&] { return stop || next < consumed + 2; });
+                    if (stop) return;
+                }
+
+                // The buffer of shard next was released, so it is only touched here until loaded is incremented
+                shards::read_shard(G, next % G.num_shards(), buffers[next % 2]);
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    loaded++;
+                }
+                changed.notify_all();
+            }
+        }
+    };
+
+
+    /**
+     * @brief Computes the contributions and the dangling mass of a rank vector, reading the out degrees from disk
+     * in blocks.
+     *
+     * @param G The sharded graph.
+     * @param x The ranks (len = n).
+     * @param contrib The vector where the contributions are written (len = n).
+     * @return The dangling mass of x.
+     */
+    double out_of_core_contributions(const shards::Sharded_Graph &G, const std::vector<double> &x, std::vector<double> &contrib) {
+        std::ifstream file(G.degree_path(), std::ios::binary);
+        std::vector<long> degree(std::min<long>(G.n, 1 << 16));
+        double dangling = 0;
+
+        for (long first = 0; first < G.n; first += degree.size()) {
+            long len = std::min<long>(degree.size(), G.n - first);
+            if (!file.read(reinterpret_cast<char*>(degree.data()), len * sizeof(long))) {
+                std::cout << "Corrupted shard directory" << std::endl;
+                exit(1);
+            }
+
+            for (long i = 0; i < len; i++) {
+                if (degree[i] != 0) {
+                    contrib[first + i] = x[first + i] / degree[i];
+                } else {
+                    contrib[first + i] = 0;
+                    dangling += x[first + i];
+                }
+            }
+        }
+
+        return dangling;
+    }
+
+
+    /**
+     * @brief Performs the Page Rank algorithm on a sharded graph, streaming the shards from disk at every iteration.
+     *
+     * The memory in use is the three rank vectors (the ranks, and the contributions of the current and of the next
+     * iterate) plus two shards, which is the budget given to shards::build. The iterate is the same as the power
+     * method of Page_Rank, so the checkpoints of the options can be used to resume long solves.
+     *
+     * @param G The sharded graph, as returned by shards::build or shards::open.
+     * @param cores The number of cores to use for parallelization.
+     * @param options The tolerance, the output for the number of iterations, the starting vector and the checkpoints.
+     *                The solver and the trace are ignored.
+     * @return A pointer to the final Page Rank vector.
+     */
+    std::vector<double>* Page_Rank_Out_Of_Core(const shards::Sharded_Graph &G, int cores, Page_Rank_Options options = Page_Rank_Options()) {
+        const double damping = 0.85;
+        long n = G.n;
+
+        int iterations = 0;
+        std::vector<double> *x = starting_vector(n, options, iterations);
+        std::vector<double> contrib(n), next_contrib(n);
+        double dangling = out_of_core_contributions(G, *x, contrib);
+
+        Shard_Stream stream(G);
+
+        double norm = 1;
+        while (norm >= options.tolerance) {
+            double base = damping*dangling/n + (1 - damping)/n;
+            double squared = 0, next_dangling = 0;
+
+            for (long k = 0; k < G.num_shards(); k++) {
+                const shards::Shard &S = stream.acquire();
+                double *v = x->data() + S.first_row, *next = next_contrib.data() + S.first_row;
+
+                // The contributions of the previous iterate are in contrib, so the ranks are overwritten in place
+                #pragma omp parallel for num_threads(cores) schedule(dynamic, 1024) reduction(+:squared, next_dangling)
+                for (long r = 0; r < S.rows; r++) {
+                    double acc = 0;
+                    for (long j = S.ROW_PTR[r]; j < S.ROW_PTR[r + 1]; j++) {
+                        acc += contrib[S.COL_INDEX[j]];
+                    }
+
+                    double y = damping*acc + base;
+                    double d = y - v[r];
+                    squared += d*d;
+
+                    v[r] = y;
+
+                    if (S.OUT_DEGREE[r] != 0) {
+                        next[r] = y / S.OUT_DEGREE[r];
+                    } else {
+                        next[r] = 0;
+                        next_dangling += y;
+                    }
+                }
+
+                stream.release();
+            }
+
+            std::swap(contrib, next_contrib);
+            dangling = next_dangling;
+            norm = sqrt(squared);
+            iterations++;
+
+            checkpoint(options, *x, iterations);
+        }
+
+        finish_checkpoint(options);
+        if (options.iterations != nullptr) *options.iterations = iterations;
+        return x;
+    }
+}
@@ -0,0 +1,272 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "par_page_rank.cpp"
+
+// ------------------ Adaptive Page Rank ------------------
+// The power method on the transposed matrix that stops recomputing the rows that have converged (Kamvar et al.):
+// only the active rows, listed once per round and read in place from the matrix, are updated, while the frozen rows keep
+// their rank and contribution. A full iteration every few iterations re-validates the frozen rows.
+
+
+namespace parallel {
+
+    /**
+     * @struct Adaptive_Options
+     * @brief The parameters of the adaptive solve, on top of the ones of Page_Rank_Options.
+     */
+    struct Adaptive_Options {
+        double freeze_factor = 1;     // A row is frozen when its change is below freeze_factor * tolerance / sqrt(n)
+        int revalidate_interval = 10; // The iterations on the active rows between two full iterations
+        double active_edges = 0.25;   // The active rows are updated alone once they hold less than this fraction of the edges
+    };
+
+
+    /**
+     * @struct Adaptive_Report
+     * @brief The work done by an adaptive solve, to compare with n and NNZ per iteration of the full solve.
+     */
+    struct Adaptive_Report {
+        int iterations = 0;       // All the iterations, full or on the active rows
+        int full_iterations = 0;  // The full iterations, which re-validate the frozen rows
+        long row_updates = 0;     // The rows computed over all the iterations
+        long edge_updates = 0;    // The in-edges read over all the iterations
+    };
+
+
+    /**
+     * @struct Active_Set
+     * @brief The rows still being updated.
+     *
+     * Their in-edges are read in place from the matrix: copying them into contiguous arrays cost about as much as the
+     * iterations it saved, since a round only runs a few iterations on the set.
+     */
+    struct Active_Set {
+        std::vector<long> rows;       // The active rows, in increasing order
+        long edges = 0;               // The in-edges of the active rows
+        double frozen_dangling = 0;   // The dangling mass of the frozen rows, which does not change
+
+
+        /**
+         * @brief Rebuilds the set from the rows that are not frozen, reusing the buffers.
+         */
+        void build(CSR_Matrix *M, const std::vector<char> &frozen, const double *x) {
+            rows.clear();
+            edges = 0;
+            frozen_dangling = 0;
+
+            for (long r = 0; r < M->n; r++) {
+                if (frozen[r]) {
+                    if (M->OUT_DEGREE[r] == 0) frozen_dangling += x[r];
+                    continue;
+                }
+
+                rows.push_back(r);
+                edges += M->ROW_PTR[r + 1] - M->ROW_PTR[r];
+            }
+        }
+    };
+
+
+    /**
+     * @brief Performs an iteration of the Page Rank algorithm on the active rows only.
+     *
+     * The contributions of the new ranks are only written once all the rows have been computed from the ones of the
+     * previous iterate, so the iteration is the same as the power method restricted to the active rows. The active rows
+     * whose change is below the threshold are marked as frozen, without being removed from the set.
+     *
+     * @param M The transposed matrix.
+     * @param A The active rows.
+     * @param x The ranks, updated on the active rows (len = n).
+     * @param contrib The contributions of x, updated on the active rows (len = n).
+     * @param scratch Space for the new contributions of the active rows (len >= A.rows.size()).
+     * @param dangling The dangling mass of x, replaced with the one after the iteration.
+     * @param threshold The change below which a row is frozen.
+     * @param frozen The flags of the frozen rows, set for the rows that converge.
+     * @param cores The number of cores to use for parallelization.
+     * @param K The kernels to use. Defaults to the ones selected at startup.
+     * @return The number of rows that converged in this iteration, and the norm of the change.
+     */
+    std::pair<long, double> page_rank_iter_active(CSR_Matrix *M, const Active_Set &A, double *x, double *contrib,
+                                                  double *scratch, double &dangling, double threshold,
+                                                  std::vector<char> &frozen, int cores, const simd::Kernels &K = simd::active) {
+        long size = A.rows.size();
+        double base = 0.85*dangling/M->n + 0.15/M->n;
+        double norm = 0, next_dangling = 0;
+        long converged = 0;
+
+        #pragma omp parallel num_threads(cores)
+        {
+            #pragma omp for schedule(dynamic, 1024) reduction(+:norm, converged)
+            for (long a = 0; a < size; a++) {
+                long r = A.rows[a];
+                double acc = K.row_sum(M->COL_INDEX.data() + M->ROW_PTR[r], M->ROW_PTR[r + 1] - M->ROW_PTR[r], contrib);
+
+                double y = 0.85*acc + base;
+                double d = y - x[r];
+                norm += d*d;
+                x[r] = y;
+                scratch[a] = M->OUT_DEGREE[r] != 0 ? y / M->OUT_DEGREE[r] : 0;
+
+                if (std::abs(d) < threshold && !frozen[r]) {
+                    frozen[r] = 1;
+                    converged++;
+                }
+            }
+
+            #pragma omp for schedule(static) reduction(+:next_dangling)
+            for (long a = 0; a < size; a++) {
+                long r = A.rows[a];
+                contrib[r] = scratch[a];
+                if (M->OUT_DEGREE[r] == 0) next_dangling += x[r];
+            }
+        }
+
+        dangling = A.frozen_dangling + next_dangling;
+        return {converged, sqrt(norm)};
+    }
+
+
+    /**
+     * @brief Performs a full iteration of the Page Rank algorithm and marks the rows whose change is below the threshold
+     * as frozen.
+     *
+     * This is page_rank_iter_simd, with the rows of every chunk compared with the previous iterate while they are still
+     * in the L1 cache, so re-validating the frozen rows costs no extra pass over the vectors.
+     *
+     * @param M The transposed matrix.
+     * @param v The input vector (len = n).
+     * @param result The vector where the result is written (len = n). It must not overlap v.
+     * @param contrib The contributions of v (len = n).
+     * @param next_contrib The vector where the contributions of the result are written (len = n).
+     * @param dangling The dangling mass of v, replaced with the one of the result.
+     * @param threshold The change below which a row is frozen.
+     * @param frozen The flags of the frozen rows, all rewritten (len = n).
+     * @param bounds The rows of every core, as returned by balanced_row_bounds (len = cores + 1).
+     * @param cores The number of cores to use for parallelization.
+     * @param K The kernels to use. Defaults to the ones selected at startup.
+     * @return The norm of the difference between the result and v, and the number of in-edges of the rows not frozen.
+     */
+    std::pair<double, long> page_rank_iter_freeze(CSR_Matrix *M, const double *v, double *result, const double *contrib,
+                                                  double *next_contrib, double &dangling, double threshold,
+                                                  std::vector<char> &frozen, const std::vector<long> &bounds, int cores,
+                                                  const simd::Kernels &K = simd::active) {
+        const long chunk = 1024;
+        double base = 0.85*dangling/M->n + 0.15/M->n;
+        double norm = 0, next_dangling = 0;
+        long active_edges = 0;
+        char *is_frozen = frozen.data();
+        const long *ROW_PTR = M->ROW_PTR.data();
+
+        #pragma omp parallel for num_threads(cores) schedule(static, 1) reduction(+:norm, next_dangling, active_edges)
+        for (int c = 0; c < cores; c++) {
+            for (long first = bounds[c]; first < bounds[c + 1]; first += chunk) {
+                long last = std::min(first + chunk, bounds[c + 1]);
+                norm += page_rank_rows_simd(M, v, result, contrib, next_contrib, base, first, last, next_dangling, K);
+
+                // Without branches, and through local pointers since the chars of the flags may alias anything, so
+                // that the loop is vectorized
+                long edges = 0;
+                for (long r = first; r < last; r++) {
+                    long converged = std::abs(result[r] - v[r]) < threshold;
+                    is_frozen[r] = (char)converged;
+                    edges += (ROW_PTR[r + 1] - ROW_PTR[r]) & (converged - 1);
+                }
+                active_edges += edges;
+            }
+        }
+
+        dangling = next_dangling;
+        return {sqrt(norm), active_edges};
+    }
+
+
+    /**
+     * @brief Performs the Page Rank algorithm, updating only the rows that have not converged yet.
+     *
+     * Every round starts with a full iteration, which re-validates all the rows: the rows whose change is below the
+     * threshold are frozen, and the others form the active set. As long as the active rows hold at least active_edges
+     * of the edges, skipping the frozen ones would not pay for listing the active rows and reading them out of order,
+     * so the rounds are plain power iterations. Otherwise up to revalidate_interval iterations update the active rows
+     * only, and the set is listed again whenever an eighth of its rows have converged. The solve stops when the norm of
+     * the change of a full iteration is below the tolerance, the same criterion as Page_Rank.
+     *
+     * The mode only saves work when parts of the graph converge much faster than others. On a well-mixed graph, such
+     * as p2p-Gnutella25 or an R-MAT graph, all the rows converge at about the same rate, the set never gets small
+     * enough, and the solve is the power method plus the cost of checking every row, up to 15% slower than Page_Rank
+     * on graphs with few edges per row. The frozen rows also carry a larger error than the others. Freezing is unsafe
+     * along long chains, whose rows look converged until the change coming down the chain reaches them.
+     *
+     * @param M The transposed matrix.
+     * @param cores The number of cores to use for parallelization.
+     * @param options The tolerance, the starting vector and the output for the number of iterations. The solver, the
+     *                checkpoints and the trace are ignored.
+     * @param adaptive The threshold to freeze the rows and the interval between the full iterations.
+     * @param report If set, receives the iterations and the rows and edges computed.
+     * @return A pointer to the final Page Rank vector.
+     */
+    std::vector<double>* Page_Rank_Adaptive(CSR_Matrix *M, int cores, Page_Rank_Options options = Page_Rank_Options(),
+                                            Adaptive_Options adaptive = Adaptive_Options(), Adaptive_Report *report = nullptr) {
+        long n = M->n;
+        const double threshold = adaptive.freeze_factor * options.tolerance / sqrt(n);
+
+        int iterations;
+        std::vector<double> *x = starting_vector(n, options, iterations);
+        std::vector<double> *y = new std::vector<double>(n);
+        std::vector<double> contrib(n), next_contrib(n);
+        std::vector<long> bounds = balanced_row_bounds(M->ROW_PTR.data(), n, cores);
+        std::vector<char> frozen(n);
+        Active_Set A;
+        Adaptive_Report r;
+
+        double dangling = prepare_contrib(n, M->OUT_DEGREE.data(), x->data(), contrib.data(), cores);
+
+        while (true) {
+            // Full iteration, which also re-validates the frozen rows
+            std::pair<double, long> full = page_rank_iter_freeze(M, x->data(), y->data(), contrib.data(), next_contrib.data(),
+                                                                 dangling, threshold, frozen, bounds, cores);
+            double norm = full.first;
+            long active_edges = full.second;
+            std::swap(x, y);
+            std::swap(contrib, next_contrib);
+            r.iterations++;
+            r.full_iterations++;
+            r.row_updates += n;
+            r.edge_updates += M->NNZ;
+
+            if (norm < options.tolerance) break;
+
+            if (active_edges >= adaptive.active_edges * M->NNZ) continue;
+            A.build(M, frozen, x->data());
+
+            // Iterations on the active rows, with y as scratch space
+            long converged = 0;
+            for (int k = 0; k < adaptive.revalidate_interval && !A.rows.empty(); k++) {
+                if (8 * converged >= (long)A.rows.size()) {
+                    A.build(M, frozen, x->data());
+                    converged = 0;
+                    if (A.rows.empty()) break;
+                }
+
+                std::pair<long, double> result = page_rank_iter_active(M, A, x->data(), contrib.data(), y->data(), dangling,
+                                                                       threshold, frozen, cores);
+                converged += result.first;
+                r.iterations++;
+                r.row_updates += A.rows.size();
+                r.edge_updates += A.edges;
+
+                if (result.second < options.tolerance) break;
+            }
+        }
+
+        if (options.iterations != nullptr) *options.iterations = iterations + r.iterations;
+        if (report != nullptr) *report = r;
+
+        delete y;
+        return x;
+    }
+}
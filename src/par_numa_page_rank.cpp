@@ -0,0 +1,84 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <cmath>
+
+#include "par_page_rank.cpp"
+#include "numa.cpp"
+
+// ------------------ NUMA-aware Page Rank ------------------
+// The power method on the row partitions with every rank vector allocated without initialization and first-touched
+// by the thread of each partition, so that with pinned threads (numa::pin_threads) every partition reads and writes
+// its rows on its own node.
+
+
+namespace parallel {
+
+    /**
+     * @brief Performs the Page Rank algorithm on the row partitions, with the rows of every rank vector first-touched
+     * by the thread of their partition.
+     *
+     * For the matrix to be local as well, numa::pin_threads must be called with the same number of cores before
+     * loading the partitions with load_graph_CSC, whose threads build one partition each. The iterates are the same
+     * as the ones of Page_Rank.
+     *
+     * @param matrices A vector of CSC_Matrix pointers, one per core.
+     * @param cores The number of cores to use for parallelization. It must be the number of partitions.
+     * @param options The tolerance, the starting vector, the checkpoints and the output for the number of iterations.
+     *                The solver and the trace are ignored.
+     * @return A pointer to the final Page Rank vector.
+     */
+    std::vector<double>* Page_Rank_NUMA(std::vector<CSC_Matrix*> &matrices, int cores, Page_Rank_Options options = Page_Rank_Options()) {
+        if ((int)matrices.size() != cores) {
+            std::cout << "Page_Rank_NUMA needs one partition per core" << std::endl;
+            exit(1);
+        }
+
+        long n = matrices[0]->n;
+        int iterations;
+        std::vector<double> *x = starting_vector(n, options, iterations);
+
+        // new double[] leaves the pages untouched, so they are placed by the first write below
+        std::unique_ptr<double[]> v(new double[n]), result(new double[n]), contrib(new double[n]), next_contrib(new double[n]);
+        double dangling = 0;
+
+        #pragma omp parallel for num_threads(cores) schedule(static, 1) reduction(+:dangling)
+        for (int c = 0; c < cores; c++) {
+            CSC_Matrix *M = matrices[c];
+            for (long r = M->first_row; r < M->first_row + M->m; r++) {
+                v[r] = (*x)[r];
+                result[r] = 0;
+                next_contrib[r] = 0;
+
+                if (M->OUT_DEGREE[r - M->first_row] != 0) {
+                    contrib[r] = v[r] / M->OUT_DEGREE[r - M->first_row];
+                } else {
+                    contrib[r] = 0;
+                    dangling += v[r];
+                }
+            }
+        }
+
+        double norm = 1;
+        while (norm >= options.tolerance) {
+            norm = page_rank_iter_fused(matrices, v.get(), result.get(), contrib.get(), next_contrib.get(), dangling, cores);
+            iterations++;
+
+            std::swap(v, result);
+            std::swap(contrib, next_contrib);
+
+            if (options.checkpoint_file != nullptr && options.checkpoint_interval > 0 && iterations % options.checkpoint_interval == 0) {
+                std::copy(v.get(), v.get() + n, x->begin());
+                checkpoint(options, *x, iterations);
+            }
+        }
+
+        finish_checkpoint(options);
+        if (options.iterations != nullptr) *options.iterations = iterations;
+
+        std::copy(v.get(), v.get() + n, x->begin());
+        return x;
+    }
+}
@@ -1,3 +1,5 @@
+#pragma once
+
 #include <iostream>
 #include <fstream>
 #include <vector>
@@ -7,28 +9,63 @@
 #include <chrono>
 #include <cmath>
 #include <numeric>
+#include <algorithm>
+#include <random>
+#include <ctime>
+#include <cstdio>
 
 #include "../datagen/par_csc_matrix.cpp"
+#include "rank_file.cpp"
+#include "simd_kernels.cpp"
+#include "telemetry.cpp"
 
 // ------------------ Page Rank ------------------
 // The Page Rank algorithm is a link analysis algorithm used by Google Search to rank websites in their search engine results.
 
 
 namespace parallel {
+    // ------------------ Options ------------------
+
+    /**
+     * @brief The iterative method used to solve the Page Rank system.
+     */
+    enum class Solver {
+        POWER,        // Power iteration: every iteration is computed from the previous one only
+        GAUSS_SEIDEL  // Block hybrid: Gauss-Seidel inside the rows of every core, Jacobi between the cores
+    };
+
+    /**
+     * @struct Page_Rank_Options
+     * @brief The parameters of a Page Rank solve.
+     */
+    struct Page_Rank_Options {
+        Solver solver = Solver::POWER;
+        double tolerance = 1e-6;    // Stop when the norm of the difference between two iterates is below this
+        int *iterations = nullptr;  // If set, receives the number of iterations performed
+
+        const std::vector<double> *initial = nullptr;  // If set, the starting vector instead of a random one
+        const char *checkpoint_file = nullptr;         // If set, the iterate is saved here and the solve resumes from it
+        int checkpoint_interval = 10;                  // The number of iterations between two checkpoints
+        telemetry::Trace *trace = nullptr;             // If set, receives the statistics of every iteration
+    };
+
+
     // ------------------ Page Rank ------------------
 
     /**
-     * @brief Generates a random vector of the specified size.
+     * @brief Generates a random vector of the specified size, normalized to sum to one.
      * 
      * @param n The size of the vector.
+     * @param seed The seed of the generator. Defaults to the current time.
      * @return A pointer to the generated vector.
      */
-    std::vector<double>* gen_random_vector(long n) {
-        static std::vector<double> *v = new std::vector<double>(n);
+    std::vector<double>* gen_random_vector(long n, unsigned seed = std::time(0)) {
+        std::vector<double> *v = new std::vector<double>(n);
 
-        std::srand(std::time(0));
-        for (int i = 0; i < n; i++) {
-            (*v)[i] = rand() % 100;
+        std::mt19937 generator(seed);
+        std::uniform_real_distribution<double> distribution(0, 1);
+        for (long i = 0; i < n; i++) {
+            (*v)[i] = distribution(generator);
         }
 
         // Normalize the vector
@@ -44,57 +81,899 @@ namespace parallel {
         return v;
     }
 
+
     /**
-     * @brief Performs a single iteration of the Page Rank algorithm.
+     * @brief Returns the starting vector of a solve: the checkpoint if there is one, else the initial vector of the
+     * options, else a random vector.
+     * 
+     * @param n The number of nodes.
+     * @param options The options of the solve.
+     * @param iterations Receives the number of iterations already performed, non-zero only when resuming.
+     * @return A pointer to the starting vector.
+     */
+    std::vector<double>* starting_vector(long n, const Page_Rank_Options &options, int &iterations) {
+        iterations = 0;
+
+        if (options.checkpoint_file != nullptr && rank_file::exists(options.checkpoint_file)) {
+            return rank_file::load(options.checkpoint_file, &iterations, n);
+        }
+
+        if (options.initial == nullptr) {
+            return gen_random_vector(n);
+        }
+
+        if ((long)options.initial->size() != n) {
+            std::cout << "The initial vector does not match the graph" << std::endl;
+            exit(1);
+        }
+
+        std::vector<double> *x = new std::vector<double>(*options.initial);
+        double sum = std::accumulate(x->begin(), x->end(), 0.0);
+        for (long i = 0; i < n; i++) {
+            (*x)[i] /= sum;
+        }
+
+        return x;
+    }
+
+
+    /**
+     * @brief Returns whether the iterate is saved to the checkpoint file of the options after the given iteration.
+     */
+    inline bool checkpoint_due(const Page_Rank_Options &options, int iterations) {
+        return options.checkpoint_file != nullptr && options.checkpoint_interval > 0 && iterations % options.checkpoint_interval == 0;
+    }
+
+
+    /**
+     * @brief Saves the iterate to the checkpoint file of the options, every checkpoint_interval iterations.
+     */
+    inline void checkpoint(const Page_Rank_Options &options, const std::vector<double> &x, int iterations) {
+        if (checkpoint_due(options, iterations)) {
+            rank_file::save(options.checkpoint_file, x, iterations);
+        }
+    }
+
+
+    /**
+     * @brief Removes the checkpoint file of the options once the solve has converged, so the next solve starts anew.
+     */
+    inline void finish_checkpoint(const Page_Rank_Options &options) {
+        if (options.checkpoint_file != nullptr) {
+            std::remove(options.checkpoint_file);
+        }
+    }
+
+    /**
+     * @brief Computes the contribution v[i]/OUT_DEGREE[i] of every node, as used by page_rank_iter_fused.
+     * 
+     * @param n The number of nodes.
+     * @param OUT_DEGREE The out degree of every node (len = n).
+     * @param v The rank vector (len = n).
+     * @param contrib The vector where the contributions are written (len = n).
+     * @param cores The number of cores to use for parallelization.
+     * @return The dangling mass, i.e. the sum of v over the nodes with no out-edges.
+     */
+    double prepare_contrib(long n, const long *OUT_DEGREE, const double *v, double *contrib, int cores) {
+        double dangling = 0;
+
+        #pragma omp parallel for num_threads(cores) schedule(static) reduction(+:dangling)
+        for (long i = 0; i < n; i++) {
+            if (OUT_DEGREE[i] != 0) {
+                contrib[i] = v[i] / OUT_DEGREE[i];
+            } else {
+                contrib[i] = 0;
+                dangling += v[i];
+            }
+        }
+
+        return dangling;
+    }
+
+    /**
+     * @brief Computes the contribution v[i]/OUT_DEGREE[i] of every node from the out degrees of the partitions.
+     * 
+     * Every partition computes the contributions of its own rows, so they are first written by the thread that
+     * computes those rows in page_rank_iter_fused.
      * 
      * @param matrices A vector of CSC_Matrix pointers.
-     * @param v The input vector.
+     * @param v The rank vector (len = n).
+     * @param contrib The vector where the contributions are written (len = n).
      * @param cores The number of cores to use for parallelization.
-     * @return A pointer to the resulting vector.
+     * @return The dangling mass, i.e. the sum of v over the nodes with no out-edges.
      */
-    std::vector<double>* page_rank_iter(std::vector<CSC_Matrix*> matrices, std::vector<double> *v, int cores) { 
-        // Calculate contribution of null columns
-        double sum = 0;
+    double prepare_contrib(std::vector<CSC_Matrix*> &matrices, const double *v, double *contrib, int cores) {
+        double dangling = 0;
 
-        for (int i = 0; i < matrices[0]->num_null_cols; i++) {
-            sum += (*v)[matrices[0]->indexes_null_cols[i]]/matrices[0]->n;
+        #pragma omp parallel for num_threads(cores) schedule(static, 1) reduction(+:dangling)
+        for (int c = 0; c < (int)matrices.size(); c++) {
+            CSC_Matrix *M = matrices[c];
+            for (long j = 0; j < M->m; j++) {
+                long r = j + M->first_row;
+                if (M->OUT_DEGREE[j] != 0) {
+                    contrib[r] = v[r] / M->OUT_DEGREE[j];
+                } else {
+                    contrib[r] = 0;
+                    dangling += v[r];
+                }
+            }
         }
 
-        std::vector<double> *result = new std::vector<double>(matrices[0]->n, 0);
+        return dangling;
+    }
+
+    /**
+     * @brief Performs a single iteration of the Page Rank algorithm.
+     * 
+     * The contributions are computed first, since a partition only holds the out degrees of its own rows, then each
+     * core multiplies its partition directly into its own rows of the output vector.
+     * 
+     * @param matrices A vector of CSC_Matrix pointers.
+     * @param v The input vector (len = n).
+     * @param result The vector where the result is written (len = n). It must not overlap v.
+     * @param contrib Scratch space for the contributions (len = n).
+     * @param cores The number of cores to use for parallelization.
+     */
+    void page_rank_iter(std::vector<CSC_Matrix*> &matrices, const double *v, double *result, double *contrib, int cores) {
+        // Calculate contribution of null columns
+        double sum = prepare_contrib(matrices, v, contrib, cores)/matrices[0]->n;
 
         #pragma omp parallel for num_threads(cores) 
         for (int i = 0; i < cores; i++) {
-            // std::cout << (*matrices[i]).NNZ << std::endl;
-            std::vector<double> *temp = (*matrices[i]) * (*v);
+            double *rows = result + (*matrices[i]).first_row;
+            std::fill(rows, rows + (*matrices[i]).m, 0.0);
+            (*matrices[i]).multiply_add(contrib, rows);
 
             for (int j = 0; j < (*matrices[i]).m; j++) {
-                (*result)[j + i*(*matrices[i]).m] = 0.85*(*temp)[j] + 0.85*sum + 0.15/matrices[0]->n;
+                rows[j] = 0.85*rows[j] + 0.85*sum + 0.15/matrices[0]->n;
             }
         }
+    }
 
-        return result;
+    /**
+     * @brief Computes the rows of one partition in an iteration of page_rank_iter_fused.
+     * 
+     * The partition scatters the contributions into its rows of the output, then a single pass over those rows applies
+     * the damping and the teleport and computes the partial norm of the difference and the contributions and dangling
+     * mass for the next iteration. The same pass clears the rows of v, which is the output buffer of the next iteration.
+     * 
+     * @param M The partition.
+     * @param v The input vector (len = n). Its rows of the partition are set to zero.
+     * @param result The vector where the result is written (len = n). Its rows of the partition must be zero on entry.
+     * @param contrib The contributions of v (len = n).
+     * @param next_contrib The vector where the contributions of the rows of the result are written (len = n).
+     * @param base The teleport and dangling term added to every rank.
+     * @param next_dangling Receives the dangling mass of the rows of the result added to its value.
+     * @return The squared norm of the difference over the rows of the partition.
+     */
+    inline double page_rank_partition_rows(CSC_Matrix *M, double *v, double *result, const double *contrib,
+                                           double *next_contrib, double base, double &next_dangling) {
+        double *rows = result + M->first_row;
+        M->multiply_add(contrib, rows);
+
+        double norm = 0;
+        for (long j = 0; j < M->m; j++) {
+            long r = j + M->first_row;
+            double x = 0.85*rows[j] + base;
+            double d = x - v[r];
+            norm += d*d;
+
+            rows[j] = x;
+            v[r] = 0;
+
+            if (M->OUT_DEGREE[j] != 0) {
+                next_contrib[r] = x / M->OUT_DEGREE[j];
+            } else {
+                next_contrib[r] = 0;
+                next_dangling += x;
+            }
+        }
+
+        return norm;
     }
 
     /**
-     * @brief Performs the Page Rank algorithm using parallel computation.
+     * @brief Performs a single iteration of the Page Rank algorithm, fused with the norm and the dangling sum.
+     * 
+     * Each core computes the rows of its partition with page_rank_partition_rows, so the vectors are traversed once
+     * per iteration. The partial sums are combined by the reduction at the end of the parallel region.
+     * 
+     * @param matrices A vector of CSC_Matrix pointers.
+     * @param v The input vector (len = n). It is set to zero.
+     * @param result The vector where the result is written (len = n). It must be zero on entry.
+     * @param contrib The contributions of v (len = n).
+     * @param next_contrib The vector where the contributions of the result are written (len = n).
+     * @param dangling The dangling mass of v, replaced with the one of the result.
+     * @param cores The number of cores to use for parallelization.
+     * @return The norm of the difference between the result and v.
+     */
+    double page_rank_iter_fused(std::vector<CSC_Matrix*> &matrices, double *v, double *result, const double *contrib,
+                                double *next_contrib, double &dangling, int cores) {
+        long n = matrices[0]->n;
+        double base = 0.85*dangling/n + 0.15/n;
+        double norm = 0, next_dangling = 0;
+
+        #pragma omp parallel for num_threads(cores) schedule(static, 1) reduction(+:norm, next_dangling)
+        for (int i = 0; i < cores; i++) {
+            norm += page_rank_partition_rows(matrices[i], v, result, contrib, next_contrib, base, next_dangling);
+        }
+
+        dangling = next_dangling;
+        return sqrt(norm);
+    }
+
+    /**
+     * @brief Performs the power method on the partitions with a parallel region per iteration.
+     * 
+     * This was the power method of Page_Rank on the partitions before it ran inside a single parallel region, kept to
+     * measure the cost of forking and joining the team at every iteration.
      * 
      * @param matrices A vector of CSC_Matrix pointers.
      * @param cores The number of cores to use for parallelization.
+     * @param options The tolerance, the starting vector, the checkpoints and the output for the number of iterations.
+     *                The solver and the trace are ignored.
      * @return A pointer to the final Page Rank vector.
      */
-    std::vector<double>* Page_Rank(std::vector<CSC_Matrix*> matrices, int cores) {
-        std::vector<double> *result, *temp = gen_random_vector(matrices[0]->n);
+    std::vector<double>* Page_Rank_Fork_Join(std::vector<CSC_Matrix*> &matrices, int cores, Page_Rank_Options options = Page_Rank_Options()) {
+        long n = matrices[0]->n;
+        int iterations;
+        std::vector<double> *temp = starting_vector(n, options, iterations);
+        std::vector<double> *result = new std::vector<double>(n, 0);
+        std::vector<double> contrib(n), next_contrib(n);
+
+        double dangling = prepare_contrib(matrices, temp->data(), contrib.data(), cores);
 
         double norm = 1;
-        while (norm >= 1e-6) { 
-            result = page_rank_iter(matrices, temp, cores);
+        while (norm >= options.tolerance) {
+            norm = page_rank_iter_fused(matrices, temp->data(), result->data(), contrib.data(), next_contrib.data(), dangling, cores);
+            iterations++;
+
+            std::swap(temp, result);
+            std::swap(contrib, next_contrib);
+
+            checkpoint(options, *temp, iterations);
+        }
+
+        finish_checkpoint(options);
+        if (options.iterations != nullptr) *options.iterations = iterations;
+
+        delete result;
+        return temp;
+    }
+
+    /**
+     * @brief Performs the Page Rank algorithm using parallel computation.
+     * 
+     * The power method runs inside a single parallel region, as Page_Rank_Persistent on the transposed matrix: every
+     * thread keeps its partition for the whole solve, and an iteration is page_rank_partition_rows, the partial norm
+     * and dangling mass of the thread written to its own cache line, and a barrier, after which every thread adds up
+     * the partial sums in the same order. The partial sums alternate between two arrays, because the fastest thread
+     * already writes the ones of the next iteration while the others still read the previous ones. All the buffers
+     * are allocated once and swapped at every iteration, so the iterations do not allocate any memory. As in
+     * Page_Rank_Persistent, the partitions are shared out by a static loop, so a smaller team still computes them all.
+     * 
+     * @param matrices A vector of CSC_Matrix pointers, one per core.
+     * @param cores The number of cores to use for parallelization.
+     * @param options The tolerance, the starting vector, the checkpoints, the trace and the output for the number of
+     *                iterations. Only the power method is available on the partitions, the solver is ignored.
+     * @return A pointer to the final Page Rank vector.
+     */
+    std::vector<double>* Page_Rank(std::vector<CSC_Matrix*> &matrices, int cores, Page_Rank_Options options = Page_Rank_Options()) {
+        struct alignas(64) Partial {
+            double norm, dangling;
+            telemetry::Clock::time_point start;  // Only measured with a trace
+            double seconds;
+        };
+
+        long n = matrices[0]->n;
+        int iterations;
+        std::vector<double> *x = starting_vector(n, options, iterations);
+        std::vector<double> *y = new std::vector<double>(n, 0);
+        std::vector<double> contrib_a(n), contrib_b(n);
+        std::vector<Partial> partials[2] = {std::vector<Partial>(cores), std::vector<Partial>(cores)};
+
+        double initial_dangling = prepare_contrib(matrices, x->data(), contrib_a.data(), cores);
+        std::vector<double> *final_x = x;
+        int final_iterations = iterations;
+
+        telemetry::Trace *trace = options.trace;
+        if (trace != nullptr) {
+            long NNZ = 0;
+            for (CSC_Matrix *M : matrices) NNZ += M->NNZ;
+            trace->start("parallel_partitioned", n, NNZ, cores, telemetry::bytes_per_iteration(n, NNZ));
+        }
+
+        #pragma omp parallel num_threads(cores)
+        {
+            std::vector<double> *v = x, *result = y;
+            double *contrib = contrib_a.data(), *next_contrib = contrib_b.data();
+            double dangling = initial_dangling, norm = 1;
+            int k = iterations;
+
+            while (norm >= options.tolerance) {
+                double base = 0.85*dangling/n + 0.15/n;
+
+                // The team may have fewer threads than cores, so the partitions are shared out rather than owned
+                // by thread number; with the full team every thread keeps the same partition at every iteration
+                #pragma omp for schedule(static, 1)
+                for (int c = 0; c < cores; c++) {
+                    Partial &mine = partials[k % 2][c];
+                    if (trace != nullptr) mine.start = telemetry::Clock::now();
+
+                    mine.dangling = 0;
+                    mine.norm = page_rank_partition_rows(matrices[c], v->data(), result->data(), contrib, next_contrib, base,
+                                                         mine.dangling);
+                    if (trace != nullptr) mine.seconds = telemetry::seconds(mine.start, telemetry::Clock::now());
+                }
+
+                double squared = 0;
+                dangling = 0;
+                for (const Partial &p : partials[k % 2]) {
+                    squared += p.norm;
+                    dangling += p.dangling;
+                }
+                norm = sqrt(squared);
+                k++;
+
+                std::swap(v, result);
+                std::swap(contrib, next_contrib);
+
+                // The next iteration clears the rows of v as it reads them, so a checkpoint holds every thread back
+                // until it is written; the partial sums of this iteration are not written before the one after
+                #pragma omp master
+                {
+                    checkpoint(options, *v, k);
+
+                    // The iteration fuses the multiplication with the rest, so it is all counted as spmv
+                    // The iteration is timed from the first thread to start it, so it is never shorter than any thread
+                    if (trace != nullptr) {
+                        double slowest = 0;
+                        telemetry::Clock::time_point first = partials[(k - 1) % 2][0].start;
+                        for (const Partial &p : partials[(k - 1) % 2]) {
+                            slowest = std::max(slowest, p.seconds);
+                            first = std::min(first, p.start);
+                        }
+
+                        telemetry::Iteration_Stats s;
+                        s.iteration = k;
+                        s.residual = norm;
+                        s.dangling = dangling;
+                        s.spmv_seconds = slowest;
+                        s.seconds = telemetry::seconds(first, telemetry::Clock::now());
+                        s.sync_seconds = s.seconds - slowest;
+                        trace->record(s);
+                    }
+                }
+
+                if (checkpoint_due(options, k)) {
+                    #pragma omp barrier
+                }
+            }
+
+            #pragma omp master
+            {
+                final_x = v;
+                final_iterations = k;
+            }
+        }
+
+        finish_checkpoint(options);
+        if (options.iterations != nullptr) *options.iterations = final_iterations;
+
+        delete (final_x == x ? y : x);
+        return final_x;
+    }
+
+
+    // ------------------ Page Rank on the transposed matrix ------------------
+
+    /**
+     * @brief Performs a single iteration of the Page Rank algorithm, pulling the contributions along the in-edges.
+     * 
+     * The contribution v[i]/OUT_DEGREE[i] of every node is computed once, then each core computes the result for a
+     * contiguous range of rows with about the same number of in-edges, reading only those in-edges from the shared matrix.
+     * 
+     * @param M The transposed matrix.
+     * @param v The input vector (len = n).
+     * @param result The vector where the result is written (len = n). It must not overlap v.
+     * @param contrib Scratch space for the contributions (len = n).
+     * @param bounds The rows of every core, as returned by balanced_row_bounds (len = cores + 1).
+     * @param cores The number of cores to use for parallelization.
+     */
+    void page_rank_iter(CSR_Matrix *M, const double *v, double *result, double *contrib, const std::vector<long> &bounds, int cores) {
+        // Calculate contribution of null columns
+        double sum = 0;
 
-            // Norm of the difference
-            norm = sqrt(inner_product(result->begin(), result->end(), temp->begin(), 0.0, std::plus<>(), [](double a, double b) { return (a - b) * (a - b); }));
-            
-            temp = result;
+        #pragma omp parallel for num_threads(cores) reduction(+:sum)
+        for (long i = 0; i < M->num_null_cols; i++) {
+            sum += v[M->indexes_null_cols[i]]/M->n;
         }
 
-        return result;
+        #pragma omp parallel for num_threads(cores) schedule(static)
+        for (long i = 0; i < M->n; i++) {
+            contrib[i] = M->OUT_DEGREE[i] != 0 ? v[i] / M->OUT_DEGREE[i] : 0;
+        }
+
+        #pragma omp parallel for num_threads(cores) schedule(static, 1)
+        for (int c = 0; c < cores; c++) {
+            for (long r = bounds[c]; r < bounds[c + 1]; r++) {
+                double acc = 0;
+                for (long j = M->ROW_PTR[r]; j < M->ROW_PTR[r + 1]; j++) {
+                    acc += contrib[M->COL_INDEX[j]];
+                }
+                result[r] = 0.85*acc + 0.85*sum + 0.15/M->n;
+            }
+        }
+    }
+
+    /**
+     * @brief Performs a single iteration of the Page Rank algorithm on the transposed matrix, fused with the norm and
+     * the dangling sum.
+     * 
+     * Each core pulls the contributions of the in-edges of its rows, and while writing every row also computes its
+     * part of the norm of the difference and of the contributions and dangling mass for the next iteration, so the
+     * vectors are traversed once per iteration.
+     * 
+     * @param M The transposed matrix.
+     * @param v The input vector (len = n).
+     * @param result The vector where the result is written (len = n). It must not overlap v.
+     * @param contrib The contributions of v (len = n).
+     * @param next_contrib The vector where the contributions of the result are written (len = n).
+     * @param dangling The dangling mass of v, replaced with the one of the result.
+     * @param bounds The rows of every core, as returned by balanced_row_bounds (len = cores + 1).
+     * @param cores The number of cores to use for parallelization.
+     * @return The norm of the difference between the result and v.
+     */
+    double page_rank_iter_fused(CSR_Matrix *M, const double *v, double *result, const double *contrib, double *next_contrib,
+                                double &dangling, const std::vector<long> &bounds, int cores) {
+        double base = 0.85*dangling/M->n + 0.15/M->n;
+        double norm = 0, next_dangling = 0;
+
+        #pragma omp parallel for num_threads(cores) schedule(static, 1) reduction(+:norm, next_dangling)
+        for (int c = 0; c < cores; c++) {
+            for (long r = bounds[c]; r < bounds[c + 1]; r++) {
+                double acc = 0;
+                for (long j = M->ROW_PTR[r]; j < M->ROW_PTR[r + 1]; j++) {
+                    acc += contrib[M->COL_INDEX[j]];
+                }
+
+                double x = 0.85*acc + base;
+                double d = x - v[r];
+                norm += d*d;
+
+                result[r] = x;
+
+                if (M->OUT_DEGREE[r] != 0) {
+                    next_contrib[r] = x / M->OUT_DEGREE[r];
+                } else {
+                    next_contrib[r] = 0;
+                    next_dangling += x;
+                }
+            }
+        }
+
+        dangling = next_dangling;
+        return sqrt(norm);
+    }
+
+    /**
+     * @brief Computes a range of rows of the iteration of page_rank_iter_simd, in chunks small enough to stay in the
+     * L1 cache.
+     * 
+     * @param M The transposed matrix.
+     * @param v The input vector (len = n).
+     * @param result The vector where the result is written (len = n). It must not overlap v.
+     * @param contrib The contributions of v (len = n).
+     * @param next_contrib The vector where the contributions of the result are written (len = n).
+     * @param base The teleport and dangling term added to every rank.
+     * @param lo The first row of the range.
+     * @param hi The end of the range.
+     * @param next_dangling Receives the dangling mass of the rows of the result added to its value.
+     * @param K The kernels to use.
+     * @param finalize_seconds If set, receives the time spent in the finalize kernel added to its value.
+     * @return The squared norm of the difference over the range.
+     */
+    inline double page_rank_rows_simd(CSR_Matrix *M, const double *v, double *result, const double *contrib, double *next_contrib,
+                                      double base, long lo, long hi, double &next_dangling, const simd::Kernels &K,
+                                      double *finalize_seconds = nullptr) {
+        const long chunk = 1024;
+        double norm = 0;
+
+        for (long first = lo; first < hi; first += chunk) {
+            long last = std::min(first + chunk, hi);
+
+            for (long r = first; r < last; r++) {
+                result[r] = K.row_sum(M->COL_INDEX.data() + M->ROW_PTR[r], M->ROW_PTR[r + 1] - M->ROW_PTR[r], contrib);
+            }
+
+            telemetry::Clock::time_point start;
+            if (finalize_seconds != nullptr) start = telemetry::Clock::now();
+
+            norm += K.finalize(last - first, M->OUT_DEGREE.data() + first, v + first, result + first,
+                               next_contrib + first, base, next_dangling);
+
+            if (finalize_seconds != nullptr) *finalize_seconds += telemetry::seconds(start, telemetry::Clock::now());
+        }
+
+        return norm;
+    }
+
+    /**
+     * @brief Performs the same iteration as page_rank_iter_fused on the transposed matrix with the vectorized kernels.
+     * 
+     * Every core processes its rows in chunks small enough to stay in the L1 cache: the sums of the in-edges of the
+     * chunk are gathered row by row, then the damping, the teleport, the norm and the next contributions are
+     * computed over the whole chunk with vector instructions.
+     * 
+     * @param M The transposed matrix.
+     * @param v The input vector (len = n).
+     * @param result The vector where the result is written (len = n). It must not overlap v.
+     * @param contrib The contributions of v (len = n).
+     * @param next_contrib The vector where the contributions of the result are written (len = n).
+     * @param dangling The dangling mass of v, replaced with the one of the result.
+     * @param bounds The rows of every core, as returned by balanced_row_bounds (len = cores + 1).
+     * @param cores The number of cores to use for parallelization.
+     * @param K The kernels to use. Defaults to the ones selected at startup.
+     * @return The norm of the difference between the result and v.
+     */
+    double page_rank_iter_simd(CSR_Matrix *M, const double *v, double *result, const double *contrib, double *next_contrib,
+                               double &dangling, const std::vector<long> &bounds, int cores, const simd::Kernels &K = simd::active) {
+        double base = 0.85*dangling/M->n + 0.15/M->n;
+        double norm = 0, next_dangling = 0;
+
+        #pragma omp parallel for num_threads(cores) schedule(static, 1) reduction(+:norm, next_dangling)
+        for (int c = 0; c < cores; c++) {
+            norm += page_rank_rows_simd(M, v, result, contrib, next_contrib, base, bounds[c], bounds[c + 1], next_dangling, K);
+        }
+
+        dangling = next_dangling;
+        return sqrt(norm);
+    }
+
+    /**
+     * @brief Performs a block Gauss-Seidel sweep of the Page Rank algorithm on the transposed matrix.
+     * 
+     * Every core updates its rows in place and in order, using the values already updated by itself in the same
+     * sweep, and the values of the previous sweep for the rows of the other cores. The dangling mass is also taken
+     * from the previous sweep. At the end of the sweep every core normalizes its rows, so that the ranks sum to one
+     * as in the power method, and publishes their contributions.
+     * 
+     * @param M The transposed matrix.
+     * @param x The rank vector, updated in place (len = n).
+     * @param contrib The contributions of x, updated in place by the core owning each row (len = n).
+     * @param shared_contrib The contributions of the previous sweep, read for the rows of the other cores (len = n).
+     * @param dangling The dangling mass of x, replaced with the one after the sweep.
+     * @param bounds The rows of every core, as returned by balanced_row_bounds (len = cores + 1).
+     * @param cores The number of cores to use for parallelization.
+     * @return The norm of the difference between x before and after the sweep.
+     */
+    double page_rank_sweep_block_gauss_seidel(CSR_Matrix *M, double *x, double *contrib, double *shared_contrib,
+                                              double &dangling, const std::vector<long> &bounds, int cores) {
+        double base = 0.85*dangling/M->n + 0.15/M->n;
+        double norm = 0, next_dangling = 0, sum = 0;
+
+        #pragma omp parallel for num_threads(cores) schedule(static, 1) reduction(+:norm, next_dangling, sum)
+        for (int c = 0; c < cores; c++) {
+            long lo = bounds[c], hi = bounds[c + 1];
+
+            for (long r = lo; r < hi; r++) {
+                double acc = 0;
+                for (long j = M->ROW_PTR[r]; j < M->ROW_PTR[r + 1]; j++) {
+                    long i = M->COL_INDEX[j];
+                    acc += (i >= lo && i < hi) ? contrib[i] : shared_contrib[i];
+                }
+
+                double value = 0.85*acc + base;
+                double d = value - x[r];
+                norm += d*d;
+                sum += value;
+                x[r] = value;
+
+                if (M->OUT_DEGREE[r] != 0) {
+                    contrib[r] = value / M->OUT_DEGREE[r];
+                } else {
+                    next_dangling += value;
+                }
+            }
+        }
+
+        #pragma omp parallel for num_threads(cores) schedule(static, 1)
+        for (int c = 0; c < cores; c++) {
+            for (long r = bounds[c]; r < bounds[c + 1]; r++) {
+                x[r] /= sum;
+                contrib[r] /= sum;
+                shared_contrib[r] = contrib[r];
+            }
+        }
+
+        dangling = next_dangling / sum;
+        return sqrt(norm);
+    }
+
+    /**
+     * @brief Performs the Page Rank algorithm with block Gauss-Seidel sweeps on the transposed matrix.
+     * 
+     * @param M The transposed matrix.
+     * @param cores The number of cores to use for parallelization.
+     * @param options The tolerance, the starting vector, the checkpoints and the output for the number of iterations.
+     *                The solver is ignored.
+     * @return A pointer to the final Page Rank vector.
+     */
+    std::vector<double>* Page_Rank_Gauss_Seidel(CSR_Matrix *M, int cores, Page_Rank_Options options = Page_Rank_Options()) {
+        int iterations;
+        std::vector<double> *x = starting_vector(M->n, options, iterations);
+        std::vector<double> contrib(M->n), shared_contrib(M->n);
+        std::vector<long> bounds = balanced_row_bounds(M->ROW_PTR.data(), M->n, cores);
+
+        double dangling = prepare_contrib(M->n, M->OUT_DEGREE.data(), x->data(), contrib.data(), cores);
+        shared_contrib = contrib;
+
+        if (options.trace != nullptr) {
+            options.trace->start("parallel_gauss_seidel", M->n, M->NNZ, cores, telemetry::bytes_per_iteration(M->n, M->NNZ));
+        }
+
+        double norm = 1;
+        while (norm >= options.tolerance) {
+            telemetry::Clock::time_point start = telemetry::Clock::now();
+            norm = page_rank_sweep_block_gauss_seidel(M, x->data(), contrib.data(), shared_contrib.data(), dangling, bounds, cores);
+            telemetry::Clock::time_point swept = telemetry::Clock::now();
+            iterations++;
+
+            checkpoint(options, *x, iterations);
+
+            // The sweep fuses the multiplication with the rest of the iteration, so it is all counted as spmv
+            if (options.trace != nullptr) {
+                telemetry::Iteration_Stats s;
+                s.iteration = iterations;
+                s.residual = norm;
+                s.dangling = dangling;
+                s.spmv_seconds = telemetry::seconds(start, swept);
+                s.seconds = telemetry::seconds(start, telemetry::Clock::now());
+                options.trace->record(s);
+            }
+        }
+
+        finish_checkpoint(options);
+        if (options.iterations != nullptr) *options.iterations = iterations;
+        return x;
+    }
+
+    /**
+     * @brief Performs the power method on the transposed matrix with a parallel region per iteration.
+     * 
+     * This was the power method of Page_Rank before Page_Rank_Persistent, kept to measure the cost of forking and
+     * joining the team at every iteration.
+     * 
+     * @param M The transposed matrix.
+     * @param cores The number of cores to use for parallelization.
+     * @param options The tolerance, the starting vector, the checkpoints and the output for the number of iterations.
+     *                The solver and the trace are ignored.
+     * @return A pointer to the final Page Rank vector.
+     */
+    std::vector<double>* Page_Rank_Fork_Join(CSR_Matrix *M, int cores, Page_Rank_Options options = Page_Rank_Options()) {
+        int iterations;
+        std::vector<double> *temp = starting_vector(M->n, options, iterations);
+        std::vector<double> *result = new std::vector<double>(M->n);
+        std::vector<double> contrib(M->n), next_contrib(M->n);
+        std::vector<long> bounds = balanced_row_bounds(M->ROW_PTR.data(), M->n, cores);
+
+        double dangling = prepare_contrib(M->n, M->OUT_DEGREE.data(), temp->data(), contrib.data(), cores);
+
+        double norm = 1;
+        while (norm >= options.tolerance) {
+            norm = page_rank_iter_simd(M, temp->data(), result->data(), contrib.data(), next_contrib.data(), dangling, bounds, cores);
+            iterations++;
+
+            std::swap(temp, result);
+            std::swap(contrib, next_contrib);
+
+            checkpoint(options, *temp, iterations);
+        }
+
+        finish_checkpoint(options);
+        if (options.iterations != nullptr) *options.iterations = iterations;
+
+        delete result;
+        return temp;
+    }
+
+    /**
+     * @brief Performs the power method on the transposed matrix inside a single parallel region.
+     * 
+     * Every thread keeps its range of rows for the whole solve. An iteration is the rows of the thread, its partial
+     * norm and dangling mass written to its own cache line, and a barrier; then every thread adds up the partial
+     * sums in the same order, so all the threads agree on the dangling mass and on convergence without a second
+     * barrier. The partial sums alternate between two arrays, because the fastest thread already writes the ones of
+     * the next iteration while the others still read the previous ones.
+     * 
+     * The ranges are shared out by a static loop over the cores, with a partial sum per range, so with a team smaller
+     * than cores, under a thread limit or in a build without OpenMP, every range is still computed at every iteration.
+     * 
+     * @param M The transposed matrix.
+     * @param cores The number of cores to use for parallelization.
+     * @param options The tolerance, the starting vector, the checkpoints and the output for the number of iterations.
+     *                The solver is ignored.
+     * @return A pointer to the final Page Rank vector.
+     */
+    std::vector<double>* Page_Rank_Persistent(CSR_Matrix *M, int cores, Page_Rank_Options options = Page_Rank_Options()) {
+        struct alignas(64) Partial {
+            double norm, dangling;
+            telemetry::Clock::time_point start;  // Only measured with a trace
+            double seconds, finalize_seconds;
+        };
+
+        int iterations;
+        std::vector<double> *x = starting_vector(M->n, options, iterations);
+        std::vector<double> *y = new std::vector<double>(M->n);
+        std::vector<double> contrib_a(M->n), contrib_b(M->n);
+        std::vector<long> bounds = balanced_row_bounds(M->ROW_PTR.data(), M->n, cores);
+        std::vector<Partial> partials[2] = {std::vector<Partial>(cores), std::vector<Partial>(cores)};
+
+        double initial_dangling = prepare_contrib(M->n, M->OUT_DEGREE.data(), x->data(), contrib_a.data(), cores);
+        std::vector<double> *final_x = x;
+        int final_iterations = iterations;
+
+        telemetry::Trace *trace = options.trace;
+        if (trace != nullptr) {
+            trace->start("parallel_power", M->n, M->NNZ, cores, telemetry::bytes_per_iteration(M->n, M->NNZ));
+        }
+
+        #pragma omp parallel num_threads(cores)
+        {
+            const simd::Kernels K = simd::active;
+
+            std::vector<double> *v = x, *result = y;
+            double *contrib = contrib_a.data(), *next_contrib = contrib_b.data();
+            double dangling = initial_dangling, norm = 1;
+            int k = iterations;
+
+            while (norm >= options.tolerance) {
+                double base = 0.85*dangling/M->n + 0.15/M->n;
+
+                // The team may have fewer threads than cores, so the ranges are shared out rather than owned by
+                // thread number; with the full team every thread keeps the same range at every iteration
+                #pragma omp for schedule(static, 1)
+                for (int c = 0; c < cores; c++) {
+                    Partial &mine = partials[k % 2][c];
+                    if (trace != nullptr) mine.start = telemetry::Clock::now();
+
+                    mine.dangling = 0;
+                    mine.finalize_seconds = 0;
+                    mine.norm = page_rank_rows_simd(M, v->data(), result->data(), contrib, next_contrib, base, bounds[c],
+                                                    bounds[c + 1], mine.dangling, K,
+                                                    trace != nullptr ? &mine.finalize_seconds : nullptr);
+                    if (trace != nullptr) mine.seconds = telemetry::seconds(mine.start, telemetry::Clock::now());
+                }
+
+                double squared = 0;
+                dangling = 0;
+                for (const Partial &p : partials[k % 2]) {
+                    squared += p.norm;
+                    dangling += p.dangling;
+                }
+                norm = sqrt(squared);
+                k++;
+
+                std::swap(v, result);
+                std::swap(contrib, next_contrib);
+
+                // No thread can write v before all the threads reach the barrier of the next iteration, nor the
+                // partial sums of this iteration before the one after
+                #pragma omp master
+                {
+                    checkpoint(options, *v, k);
+
+                    // The iteration is timed from the first thread to start it, so it is never shorter than any thread
+                    if (trace != nullptr) {
+                        const Partial *slowest = &partials[(k - 1) % 2][0];
+                        telemetry::Clock::time_point first = slowest->start;
+                        for (const Partial &p : partials[(k - 1) % 2]) {
+                            if (p.seconds > slowest->seconds) slowest = &p;
+                            first = std::min(first, p.start);
+                        }
+
+                        telemetry::Iteration_Stats s;
+                        s.iteration = k;
+                        s.residual = norm;
+                        s.dangling = dangling;
+                        s.spmv_seconds = slowest->seconds - slowest->finalize_seconds;
+                        s.finalize_seconds = slowest->finalize_seconds;
+                        s.seconds = telemetry::seconds(first, telemetry::Clock::now());
+                        s.sync_seconds = s.seconds - slowest->seconds;
+                        trace->record(s);
+                    }
+                }
+            }
+
+            #pragma omp master
+            {
+                final_x = v;
+                final_iterations = k;
+            }
+        }
+
+        finish_checkpoint(options);
+        if (options.iterations != nullptr) *options.iterations = final_iterations;
+
+        delete (final_x == x ? y : x);
+        return final_x;
+    }
+
+    /**
+     * @brief Performs the Page Rank algorithm using parallel computation on the transposed matrix.
+     * 
+     * The power method runs inside a single parallel region (Page_Rank_Persistent), with all the buffers allocated
+     * once, so the iterations do not allocate any memory, and with the vectorized kernels selected for the CPU at
+     * startup (see simd_kernels.cpp).
+     * 
+     * @param M The transposed matrix.
+     * @param cores The number of cores to use for parallelization.
+     * @param options The solver, the tolerance, the starting vector and the checkpoints. Defaults to the power method
+     *                with tolerance 1e-6 from a random vector. When a checkpoint file is set and exists, the solve resumes
+     *                from it, and it is removed once the solve converges.
+     * @return A pointer to the final Page Rank vector.
+     */
+    std::vector<double>* Page_Rank(CSR_Matrix *M, int cores, Page_Rank_Options options = Page_Rank_Options()) {
+        if (options.solver == Solver::GAUSS_SEIDEL) {
+            return Page_Rank_Gauss_Seidel(M, cores, options);
+        }
+
+        return Page_Rank_Persistent(M, cores, options);
+    }
+
+
+    /**
+     * @brief Performs the Page Rank algorithm on the transposed matrix and returns the ranks with the statistics of
+     * every iteration.
+     * 
+     * @param M The transposed matrix.
+     * @param cores The number of cores to use for parallelization.
+     * @param options The parameters of the solve, as for Page_Rank. The trace and the output for the number of
+     *                iterations are ignored.
+     * @param on_iteration If set, called after every iteration with its statistics, on the master thread.
+     * @return The ranks, the number of iterations, the time of the solve and its trace.
+     */
+    telemetry::Page_Rank_Result Page_Rank_Traced(CSR_Matrix *M, int cores, Page_Rank_Options options = Page_Rank_Options(),
+                                                 telemetry::Iteration_Callback on_iteration = nullptr) {
+        telemetry::Page_Rank_Result r;
+        r.trace.on_iteration = on_iteration;
+        options.trace = &r.trace;
+        options.iterations = &r.iterations;
+
+        telemetry::Clock::time_point start = telemetry::Clock::now();
+        std::vector<double> *x = Page_Rank(M, cores, options);
+        r.seconds = telemetry::seconds(start, telemetry::Clock::now());
+
+        r.ranks = std::move(*x);
+        delete x;
+        return r;
+    }
+
+    /**
+     * @brief Performs the Page Rank algorithm on the partitions and returns the ranks with the statistics of every
+     * iteration.
+     * 
+     * @param matrices A vector of CSC_Matrix pointers.
+     * @param cores The number of cores to use for parallelization.
+     * @param options The parameters of the solve, as for Page_Rank. The trace and the output for the number of
+     *                iterations are ignored.
+     * @param on_iteration If set, called after every iteration with its statistics.
+     * @return The ranks, the number of iterations, the time of the solve and its trace.
+     */
+    telemetry::Page_Rank_Result Page_Rank_Traced(std::vector<CSC_Matrix*> &matrices, int cores,
+                                                 Page_Rank_Options options = Page_Rank_Options(),
+                                                 telemetry::Iteration_Callback on_iteration = nullptr) {
+        telemetry::Page_Rank_Result r;
+        r.trace.on_iteration = on_iteration;
+        options.trace = &r.trace;
+        options.iterations = &r.iterations;
+
+        telemetry::Clock::time_point start = telemetry::Clock::now();
+        std::vector<double> *x = Page_Rank(matrices, cores, options);
+        r.seconds = telemetry::seconds(start, telemetry::Clock::now());
+
+        r.ranks = std::move(*x);
+        delete x;
+        return r;
     }
-}
\ No newline at end of file
+}
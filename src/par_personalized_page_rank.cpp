@@ -0,0 +1,264 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <memory>
+
+#include "par_page_rank.cpp"
+
+// ------------------ Personalized Page Rank ------------------
+// In the personalized Page Rank the random surfer teleports, and leaves the dangling nodes, according to a given
+// teleport vector instead of uniformly, so the ranks measure the proximity to the nodes of the teleport vector.
+
+
+namespace parallel {
+
+    const int LINE_DOUBLES = 64 / sizeof(double);  // The doubles in a cache line
+
+
+    /**
+     * @brief Returns the doubles between the partial sums of two cores for k columns: the k norms and the k dangling
+     * masses of a core, rounded up to whole cache lines so that no two cores write the same line.
+     */
+    inline long partial_stride(int k) {
+        return (2*k + LINE_DOUBLES - 1) / LINE_DOUBLES * LINE_DOUBLES;
+    }
+
+
+    /**
+     * @brief Builds the teleport vector of a seed set: uniform over the seeds and zero elsewhere.
+     *
+     * @param n The number of nodes.
+     * @param seeds The seed nodes, at least one, each in [0, n).
+     * @return The teleport vector (len = n).
+     */
+    std::vector<double> teleport_from_seeds(long n, const std::vector<long> &seeds) {
+        if (seeds.empty()) {
+            std::cout << "The seed set is empty" << std::endl;
+            exit(1);
+        }
+        for (long s : seeds) {
+            if (s < 0 || s >= n) {
+                std::cout << "Seed " << s << " is not a node of the graph" << std::endl;
+                exit(1);
+            }
+        }
+
+        std::vector<double> teleport(n, 0);
+        for (long s : seeds) {
+            teleport[s] += 1.0 / seeds.size();
+        }
+
+        return teleport;
+    }
+
+
+    /**
+     * @brief Keeps only the given columns of an n x k row-major block.
+     *
+     * @param from The block with k columns.
+     * @param to The block where the kept columns are written, with keep.size() columns.
+     * @param n The number of rows.
+     * @param k The number of columns of from.
+     * @param keep The indexes of the columns to keep.
+     * @param cores The number of cores to use for parallelization.
+     */
+    void compact_columns(const double *from, double *to, long n, int k, const std::vector<int> &keep, int cores) {
+        int kept = keep.size();
+
+        #pragma omp parallel for num_threads(cores) schedule(static)
+        for (long r = 0; r < n; r++) {
+            for (int q = 0; q < kept; q++) {
+                to[r*kept + q] = from[r*k + keep[q]];
+            }
+        }
+    }
+
+
+    /**
+     * @brief Performs one iteration of k personalized Page Ranks at once on the transposed matrix.
+     *
+     * The rank vectors are stored as an n x k row-major block, so every in-edge is read once and applied to the k
+     * contiguous contributions of its source. As in page_rank_iter_fused, the same pass produces the contributions,
+     * the dangling mass and the squared norm of the difference of every column.
+     *
+     * @param M The transposed matrix.
+     * @param k The number of columns.
+     * @param x The current ranks (n x k).
+     * @param contrib The contributions of x (n x k).
+     * @param dangling The dangling mass of every column of x (len = k).
+     * @param teleport The teleport vectors (n x k).
+     * @param damping The damping factor of every column (len = k).
+     * @param next_x The block where the next ranks are written (n x k).
+     * @param next_contrib The block where the contributions of next_x are written (n x k).
+     * @param next_dangling Receives the dangling mass of every column of next_x (len = k).
+     * @param norm Receives the squared norm of the difference of every column (len = k).
+     * @param partial Scratch space for the per-core sums, aligned to 64 bytes (len = cores * partial_stride(k)).
+     * @param bounds The rows of every core, as returned by balanced_row_bounds (len = cores + 1).
+     * @param cores The number of cores to use for parallelization.
+     */
+    void personalized_iter_batch(CSR_Matrix *M, int k, const double *x, const double *contrib, const double *dangling,
+                                 const double *teleport, const double *damping, double *next_x, double *next_contrib,
+                                 double *next_dangling, double *norm, double *partial, const std::vector<long> &bounds, int cores) {
+        const long stride = partial_stride(k);
+        std::fill(partial, partial + cores*stride, 0.0);
+
+        #pragma omp parallel for num_threads(cores) schedule(static, 1)
+        for (int c = 0; c < cores; c++) {
+            double *local_norm = partial + c*stride;
+            double *local_dangling = local_norm + k;
+
+            for (long r = bounds[c]; r < bounds[c + 1]; r++) {
+                double *out = next_x + r*k;
+                std::fill(out, out + k, 0.0);
+
+                for (long j = M->ROW_PTR[r]; j < M->ROW_PTR[r + 1]; j++) {
+                    const double *in = contrib + M->COL_INDEX[j]*k;
+                    for (int q = 0; q < k; q++) {
+                        out[q] += in[q];
+                    }
+                }
+
+                const double *t = teleport + r*k;
+                for (int q = 0; q < k; q++) {
+                    double value = damping[q]*(out[q] + dangling[q]*t[q]) + (1 - damping[q])*t[q];
+                    double d = value - x[r*k + q];
+                    local_norm[q] += d*d;
+                    out[q] = value;
+                }
+
+                double *next = next_contrib + r*k;
+                if (M->OUT_DEGREE[r] != 0) {
+                    for (int q = 0; q < k; q++) {
+                        next[q] = out[q] / M->OUT_DEGREE[r];
+                    }
+                } else {
+                    for (int q = 0; q < k; q++) {
+                        next[q] = 0;
+                        local_dangling[q] += out[q];
+                    }
+                }
+            }
+        }
+
+        for (int q = 0; q < k; q++) {
+            norm[q] = 0;
+            next_dangling[q] = 0;
+            for (int c = 0; c < cores; c++) {
+                norm[q] += partial[c*stride + q];
+                next_dangling[q] += partial[c*stride + k + q];
+            }
+        }
+    }
+
+
+    /**
+     * @brief Computes many personalized Page Ranks at once.
+     *
+     * All the rank vectors are iterated together as an n x k block, so every iteration streams the matrix once for
+     * all of them. Every column is checked for convergence separately: as soon as a column converges its ranks are
+     * stored in the result and the column is removed from the block, so the following iterations only work on the
+     * columns that are still running.
+     *
+     * @param M The transposed matrix.
+     * @param teleports The k teleport vectors (each of len = n, summing to one).
+     * @param cores The number of cores to use for parallelization.
+     * @param damping The damping factor of every teleport vector, in [0, 1) (len = k). Defaults to 0.85 for all of them.
+     * @param options The tolerance and the output for the number of iterations of the slowest column. The solver, the starting
+     *                vector, the checkpoints and the trace are ignored.
+     * @return A pointer to the k rank vectors, in the order of the teleport vectors.
+     */
+    std::vector<std::vector<double>>* Personalized_Page_Rank_Batch(CSR_Matrix *M, const std::vector<std::vector<double>> &teleports, int cores,
+                                                                   std::vector<double> damping = std::vector<double>(),
+                                                                   Page_Rank_Options options = Page_Rank_Options()) {
+        long n = M->n;
+        int k = teleports.size();
+        if (damping.empty()) damping.assign(k, 0.85);
+        if ((int)damping.size() != k) {
+            std::cout << "Expected " << k << " damping factors, got " << damping.size() << std::endl;
+            exit(1);
+        }
+        for (int q = 0; q < k; q++) {
+            // A damping factor of 1 or more never converges, and the negation also rejects NaN
+            if (!(damping[q] >= 0 && damping[q] < 1)) {
+                std::cout << "The damping factor " << damping[q] << " is not in [0, 1)" << std::endl;
+                exit(1);
+            }
+            if ((long)teleports[q].size() != n) {
+                std::cout << "The teleport vector " << q << " does not match the graph" << std::endl;
+                exit(1);
+            }
+        }
+
+        std::vector<std::vector<double>> *result = new std::vector<std::vector<double>>(k);
+        std::vector<long> bounds = balanced_row_bounds(M->ROW_PTR.data(), n, cores);
+
+        // Blocks of the active columns, and the original index of every active column
+        std::vector<double> x(n*k), contrib(n*k), teleport(n*k), next_x(n*k), next_contrib(n*k), spare(n*k);
+        std::vector<double> dangling(k, 0), next_dangling(k), norm(k);
+        std::vector<int> column(k);
+
+        // The columns only decrease, so the partial sums of the first iteration are the largest
+        std::vector<double> partial_buffer(cores*partial_stride(k) + LINE_DOUBLES);
+        void *aligned = partial_buffer.data();
+        size_t space = partial_buffer.size() * sizeof(double);
+        double *partial = static_cast<double*>(std::align(64, cores*partial_stride(k)*sizeof(double), aligned, space));
+
+        // Start from the teleport vectors themselves
+        for (int q = 0; q < k; q++) {
+            column[q] = q;
+            for (long r = 0; r < n; r++) {
+                teleport[r*k + q] = teleports[q][r];
+                x[r*k + q] = teleports[q][r];
+                contrib[r*k + q] = M->OUT_DEGREE[r] != 0 ? teleports[q][r] / M->OUT_DEGREE[r] : 0;
+                if (M->OUT_DEGREE[r] == 0) dangling[q] += teleports[q][r];
+            }
+        }
+
+        int iterations = 0;
+        while (k > 0) {
+            personalized_iter_batch(M, k, x.data(), contrib.data(), dangling.data(), teleport.data(), damping.data(),
+                                    next_x.data(), next_contrib.data(), next_dangling.data(), norm.data(), partial, bounds, cores);
+            iterations++;
+
+            std::swap(x, next_x);
+            std::swap(contrib, next_contrib);
+            std::swap(dangling, next_dangling);
+
+            // Store the converged columns and keep the others
+            std::vector<int> keep;
+            for (int q = 0; q < k; q++) {
+                if (sqrt(norm[q]) < options.tolerance) {
+                    std::vector<double> &ranks = (*result)[column[q]];
+                    ranks.resize(n);
+                    for (long r = 0; r < n; r++) {
+                        ranks[r] = x[r*k + q];
+                    }
+                } else {
+                    keep.push_back(q);
+                }
+            }
+
+            if ((int)keep.size() == k) continue;
+
+            compact_columns(x.data(), next_x.data(), n, k, keep, cores);
+            compact_columns(contrib.data(), next_contrib.data(), n, k, keep, cores);
+            compact_columns(teleport.data(), spare.data(), n, k, keep, cores);
+            std::swap(x, next_x);
+            std::swap(contrib, next_contrib);
+            std::swap(teleport, spare);
+
+            for (int q = 0; q < (int)keep.size(); q++) {
+                column[q] = column[keep[q]];
+                damping[q] = damping[keep[q]];
+                dangling[q] = dangling[keep[q]];
+            }
+            k = keep.size();
+        }
+
+        if (options.iterations != nullptr) *options.iterations = iterations;
+        return result;
+    }
+}
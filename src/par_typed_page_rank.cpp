@@ -0,0 +1,201 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+
+#include "par_page_rank.cpp"
+
+// ------------------ Page Rank with compact types ------------------
+// The pull iteration on the transposed matrix, templated on the type of the indexes (uint32_t or uint64_t) and of
+// the rank vectors (float or double), to trade accuracy for memory bandwidth on graphs that allow it.
+
+
+namespace parallel {
+
+    /**
+     * @brief The floating point types of a solve.
+     */
+    enum class Precision {
+        DOUBLE,  // Ranks and sums in double
+        FLOAT,   // Ranks and sums in float
+        MIXED    // Ranks in float, sums of the in-edges, norm and dangling mass in double
+    };
+
+    const char* precision_name(Precision precision) {
+        switch (precision) {
+            case Precision::FLOAT: return "float";
+            case Precision::MIXED: return "mixed";
+            default: return "double";
+        }
+    }
+
+
+    /**
+     * @struct Typed_Report
+     * @brief What a solve with compact types moved and chose.
+     */
+    struct Typed_Report {
+        int index_bits = 64;           // The width of the indexes chosen for the graph
+        long bytes_per_iteration = 0;  // The bytes read and written by every iteration, counting one read per in-edge
+        int iterations = 0;
+        bool converged = true;         // Whether the norm fell below the tolerance, which the float ranks may not reach
+    };
+
+
+    /**
+     * @brief Returns the bytes moved by an iteration of page_rank_iter_typed.
+     *
+     * Every iteration reads the row pointers, the in-edges and the contribution of every in-edge, reads the previous
+     * ranks and the out degrees, and writes the ranks and the contributions.
+     */
+    template <typename Value, typename Index>
+    long bytes_per_iteration(long n, long NNZ) {
+        return (n + 1) * sizeof(Index) + NNZ * (sizeof(Index) + sizeof(Value)) + n * (3 * sizeof(Value) + sizeof(Index));
+    }
+
+
+    /**
+     * @brief Performs a single iteration of the Page Rank algorithm on a compact transposed matrix.
+     *
+     * This is page_rank_iter_fused with the ranks and contributions stored as Value and the sums, the norm and the
+     * dangling mass accumulated as Accum.
+     *
+     * @param M The transposed matrix.
+     * @param v The input vector (len = n).
+     * @param result The vector where the result is written (len = n). It must not overlap v.
+     * @param contrib The contributions of v (len = n).
+     * @param next_contrib The vector where the contributions of the result are written (len = n).
+     * @param dangling The dangling mass of v, replaced with the one of the result.
+     * @param bounds The rows of every core, as returned by balanced_row_bounds (len = cores + 1).
+     * @param cores The number of cores to use for parallelization.
+     * @return The norm of the difference between the result and v.
+     */
+    template <typename Value, typename Accum, typename Index>
+    Accum page_rank_iter_typed(Compact_CSR_Matrix<Index> *M, const Value *v, Value *result, const Value *contrib,
+                               Value *next_contrib, Accum &dangling, const std::vector<long> &bounds, int cores) {
+        const Accum damping = 0.85;
+        Accum base = damping*dangling/M->n + (1 - damping)/M->n;
+        Accum norm = 0, next_dangling = 0;
+
+        #pragma omp parallel for num_threads(cores) schedule(static, 1) reduction(+:norm, next_dangling)
+        for (int c = 0; c < cores; c++) {
+            for (long r = bounds[c]; r < bounds[c + 1]; r++) {
+                Accum acc = 0;
+                for (Index j = M->ROW_PTR[r]; j < M->ROW_PTR[r + 1]; j++) {
+                    acc += contrib[M->COL_INDEX[j]];
+                }
+
+                Accum x = damping*acc + base;
+                Accum d = x - v[r];
+                norm += d*d;
+
+                result[r] = x;
+
+                if (M->OUT_DEGREE[r] != 0) {
+                    next_contrib[r] = x / M->OUT_DEGREE[r];
+                } else {
+                    next_contrib[r] = 0;
+                    next_dangling += x;
+                }
+            }
+        }
+
+        dangling = next_dangling;
+        return sqrt(norm);
+    }
+
+
+    /**
+     * @brief Performs the Page Rank algorithm on a compact transposed matrix with the given types.
+     *
+     * Float ranks cannot reach tolerances below their rounding error, so with float ranks the solve also stops when
+     * the norm of the difference stops decreasing. Double ranks always iterate down to the tolerance.
+     *
+     * @param M The transposed matrix.
+     * @param cores The number of cores to use for parallelization.
+     * @param options The tolerance and the output for the number of iterations. The solver, the starting vector,
+     *                the checkpoints and the trace are ignored.
+     * @param converged If set, receives whether the norm fell below the tolerance rather than stopped decreasing.
+     * @return A pointer to the final Page Rank vector, converted to double.
+     */
+    template <typename Value, typename Accum, typename Index>
+    std::vector<double>* Page_Rank_Typed(Compact_CSR_Matrix<Index> *M, int cores, Page_Rank_Options options = Page_Rank_Options(),
+                                         bool *converged = nullptr) {
+        long n = M->n;
+        std::vector<Value> v(n, Value(1) / n), result(n), contrib(n), next_contrib(n);
+        std::vector<long> bounds = balanced_row_bounds(M->ROW_PTR.data(), n, cores);
+
+        Accum dangling = 0;
+        for (long i = 0; i < n; i++) {
+            if (M->OUT_DEGREE[i] != 0) {
+                contrib[i] = v[i] / M->OUT_DEGREE[i];
+            } else {
+                dangling += v[i];
+            }
+        }
+
+        int iterations = 0;
+        Accum norm = 1, previous = INFINITY;
+        while (norm >= options.tolerance) {
+            norm = page_rank_iter_typed<Value, Accum, Index>(M, v.data(), result.data(), contrib.data(), next_contrib.data(),
+                                                             dangling, bounds, cores);
+            iterations++;
+
+            std::swap(v, result);
+            std::swap(contrib, next_contrib);
+
+            if (std::is_same<Value, float>::value && norm >= previous) break;
+            previous = norm;
+        }
+
+        if (options.iterations != nullptr) *options.iterations = iterations;
+        if (converged != nullptr) *converged = norm < options.tolerance;
+        return new std::vector<double>(v.begin(), v.end());
+    }
+
+
+    /**
+     * @brief Performs the Page Rank algorithm on a graph loaded with load_graph_compact, with the index width it was
+     * loaded with and the given precision.
+     *
+     * @param G The transposed matrix.
+     * @param cores The number of cores to use for parallelization.
+     * @param precision The floating point types.
+     * @param options The tolerance and the output for the number of iterations. The trace is ignored.
+     * @param report If set, receives the index width, the bytes per iteration, the iterations and whether the
+     *               tolerance was reached.
+     * @return A pointer to the final Page Rank vector.
+     */
+    std::vector<double>* Page_Rank_Compact(Compact_Graph *G, int cores, Precision precision,
+                                           Page_Rank_Options options = Page_Rank_Options(), Typed_Report *report = nullptr) {
+        Typed_Report r;
+        if (options.iterations == nullptr) options.iterations = &r.iterations;
+
+        auto solve = [&](auto *M) -> std::vector<double>* {
+            using Index = typename decltype(M->COL_INDEX)::value_type;
+            r.index_bits = 8 * sizeof(Index);
+
+            switch (precision) {
+                case Precision::FLOAT:
+                    r.bytes_per_iteration = bytes_per_iteration<float, Index>(M->n, M->NNZ);
+                    return Page_Rank_Typed<float, float>(M, cores, options, &r.converged);
+                case Precision::MIXED:
+                    r.bytes_per_iteration = bytes_per_iteration<float, Index>(M->n, M->NNZ);
+                    return Page_Rank_Typed<float, double>(M, cores, options, &r.converged);
+                default:
+                    r.bytes_per_iteration = bytes_per_iteration<double, Index>(M->n, M->NNZ);
+                    return Page_Rank_Typed<double, double>(M, cores, options, &r.converged);
+            }
+        };
+
+        std::vector<double> *ranks = G->narrow != nullptr ? solve(G->narrow) : solve(G->wide);
+
+        r.iterations = *options.iterations;
+        if (report != nullptr) *report = r;
+        return ranks;
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstring>
+#include <cstdint>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/**
+ * @namespace perf
+ * @brief A minimal wrapper around perf_event_open to count hardware events in user space.
+ */
+namespace perf {
+
+    /**
+     * @struct Counter
+     * @brief Counts a hardware event of the calling thread between start() and stop().
+     *
+     * When the kernel does not allow the counter (e.g. in containers or with a high perf_event_paranoid) the counter
+     * is not available and stop() returns -1.
+     */
+    struct Counter {
+        int fd = -1;
+
+        explicit Counter(uint64_t config = PERF_COUNT_HW_CACHE_MISSES) {
+            struct perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.inherit = 1;
+
+            fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        }
+
+        Counter(const Counter&) = delete;
+        Counter& operator=(const Counter&) = delete;
+
+        ~Counter() {
+            if (fd >= 0) close(fd);
+        }
+
+        bool available() const {
+            return fd >= 0;
+        }
+
+        void start() {
+            if (fd < 0) return;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+
+        long stop() {
+            if (fd < 0) return -1;
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+
+            long long count = 0;
+            if (read(fd, &count, sizeof(count)) != sizeof(count)) return -1;
+            return count;
+        }
+    };
+}
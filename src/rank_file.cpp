@@ -0,0 +1,158 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+
+/**
+ * @namespace rank_file
+ * @brief Contains the binary format of a rank vector, used both for the results of a solve and for its checkpoints.
+ *
+ * The file is a fixed size header, with the number of nodes and the number of iterations performed to compute the
+ * vector, followed by the n ranks as doubles.
+ */
+namespace rank_file {
+
+    const char MAGIC[8] = {'P', 'R', 'R', 'A', 'N', 'K', '\0', '\0'};
+    const uint32_t VERSION = 1;
+
+    /**
+     * @struct Header
+     * @brief The header at the beginning of a rank file.
+     */
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        int32_t iterations;
+        int64_t n;
+    };
+
+
+    /**
+     * @brief Checks whether the given file exists and can be opened.
+     */
+    bool exists(const char *filename) {
+        std::ifstream file(filename, std::ios::binary);
+        return file.is_open();
+    }
+
+
+    /**
+     * @brief Writes a rank vector to a file.
+     *
+     * The vector is first written to a temporary file that is then renamed, so a process killed while writing
+     * leaves the previous file intact.
+     *
+     * @param filename The name of the output file.
+     * @param x The rank vector.
+     * @param iterations The number of iterations performed to compute x. Defaults to 0.
+     */
+    void save(const char *filename, const std::vector<double> &x, int iterations = 0) {
+        std::string temp = std::string(filename) + ".tmp";
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+
+        if (!file.is_open()) {
+            std::cout << "Unable to open file" << std::endl;
+            exit(1);
+        }
+
+        Header h;
+        std::memset(&h, 0, sizeof(h));
+        std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+        h.version = VERSION;
+        h.iterations = iterations;
+        h.n = x.size();
+
+        file.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        file.write(reinterpret_cast<const char*>(x.data()), x.size() * sizeof(double));
+        file.close();
+
+        if (!file || std::rename(temp.c_str(), filename) != 0) {
+            std::cout << "Error while writing the rank file" << std::endl;
+            exit(1);
+        }
+    }
+
+
+    /**
+     * @brief Checks that the size of an open rank file is the one of its header and n ranks, leaving the file at the
+     * first rank.
+     *
+     * The comparison is made on the number of ranks the file can hold, so a corrupted n can neither overflow nor
+     * make the reader allocate more than the file holds.
+     */
+    bool size_matches(std::ifstream &file, const Header &h) {
+        file.seekg(0, std::ios::end);
+        std::streamoff size = file.tellg();
+        file.seekg(sizeof(Header));
+
+        std::streamoff body = size - (std::streamoff)sizeof(Header);
+        return file && h.n >= 0 && body % sizeof(double) == 0 && (uint64_t)h.n == (uint64_t)body / sizeof(double);
+    }
+
+
+    /**
+     * @brief Reads the header of a rank file, without the ranks.
+     *
+     * @param filename The name of the rank file.
+     * @param h Receives the header.
+     * @return false if the file cannot be read, is not a rank file of this version or does not hold n ranks.
+     */
+    bool read_header(const char *filename, Header &h) {
+        std::ifstream file(filename, std::ios::binary);
+        return file.read(reinterpret_cast<char*>(&h), sizeof(h)) && std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+               h.version == VERSION && size_matches(file, h);
+    }
+
+
+    /**
+     * @brief Reads a rank vector from a file.
+     *
+     * The size of the file is checked against the header, and the header against the expected number of nodes,
+     * before the vector is allocated.
+     *
+     * @param filename The name of the rank file.
+     * @param iterations If set, receives the number of iterations stored in the file.
+     * @param n The number of nodes of the graph the vector is for, or -1 to accept any. Defaults to -1.
+     * @return A pointer to the rank vector.
+     */
+    std::vector<double>* load(const char *filename, int *iterations = nullptr, long n = -1) {
+        std::ifstream file(filename, std::ios::binary);
+
+        if (!file.is_open()) {
+            std::cout << "Unable to open file" << std::endl;
+            exit(1);
+        }
+
+        Header h;
+        if (!file.read(reinterpret_cast<char*>(&h), sizeof(h)) || std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0) {
+            std::cout << "Invalid rank file" << std::endl;
+            exit(1);
+        }
+        if (h.version != VERSION) {
+            std::cout << "Unsupported rank file version: " << h.version << std::endl;
+            exit(1);
+        }
+        if (!size_matches(file, h)) {
+            std::cout << "Corrupted rank file" << std::endl;
+            exit(1);
+        }
+        if (n >= 0 && h.n != n) {
+            std::cout << "The rank file does not match the graph" << std::endl;
+            exit(1);
+        }
+
+        std::vector<double> *x = new std::vector<double>(h.n);
+        if (!file.read(reinterpret_cast<char*>(x->data()), h.n * sizeof(double))) {
+            std::cout << "Corrupted rank file" << std::endl;
+            exit(1);
+        }
+
+        if (iterations != nullptr) *iterations = h.iterations;
+        return x;
+    }
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+
+#include "../datagen/dynamic_csc_matrix.cpp"
+#include "seq_personalized_page_rank.cpp"
+
+// ------------------ Incremental Page Rank ------------------
+// When some edges change, the previous ranks x are still the solution of the old system, so the error of x on the
+// new system is a residual that is non-zero only around the sources of the changed edges. Pushing that residual, as
+// in the forward push, corrects x while only visiting the nodes the change actually reaches.
+
+
+namespace sequential {
+
+    /**
+     * @brief Adds to the residual the contribution of the out-edges of u, with the given sign.
+     *
+     * The rank of a dangling node is spread over all the nodes. A uniform residual only rescales the solution, so it
+     * is not stored per node: it is accumulated in uniform and removed by the normalization at the end of the update.
+     */
+    void add_out_contribution(Dynamic_CSC_Matrix &G, long u, double mass, Local_Push_Workspace &W, double &uniform) {
+        long degree = G.OUT_DEGREE[u];
+        if (degree == 0) {
+            uniform += 0.85 * mass / G.n;
+            return;
+        }
+
+        double share = 0.85 * mass / degree;
+        G.for_each_out_edge(u, [&](long v) {
+            if (W.residual[v] == 0) W.touched.push_back(v);
+            W.residual[v] += share;
+        });
+    }
+
+
+    /**
+     * @brief Applies a batch of edge changes to the graph and updates the Page Rank vector incrementally.
+     *
+     * The residual of the previous ranks on the new graph is computed from the old and new out-edges of the changed
+     * sources only, added to the residual left by the previous updates, then pushed until every residual is below
+     * epsilon times the out degree of its node. What is left below the threshold stays in the workspace for the next
+     * update, so it is pushed once it adds up instead of being lost, and the error stays within the L1 norm of the
+     * residual divided by 1 - 0.85; clear the workspace after solving the graph again from scratch. The ranks are normalized at the end when a dangling node appeared or disappeared, which is
+     * the only case that needs a full pass over the vector. At the end the graph is compacted if its delta buffer
+     * became too large, which does not change the residual.
+     *
+     * @param G The graph, modified in place.
+     * @param x The Page Rank vector of G before the changes, updated in place (len = n).
+     * @param insertions The edges to add, as (source, destination) pairs.
+     * @param deletions The edges to remove, as (source, destination) pairs.
+     * @param W A workspace created for G, reused across updates, which keeps the residual between them.
+     * @param epsilon The residual threshold per out-edge. Defaults to 1e-9.
+     * @return The number of pushes performed.
+     */
+    long Page_Rank_Update(Dynamic_CSC_Matrix &G, std::vector<double> &x,
+                          const std::vector<std::pair<long, long>> &insertions, const std::vector<std::pair<long, long>> &deletions,
+                          Local_Push_Workspace &W, double epsilon = 1e-9) {
+        std::vector<long> sources;
+        for (auto &e : insertions) sources.push_back(e.first);
+        for (auto &e : deletions) sources.push_back(e.first);
+        std::sort(sources.begin(), sources.end());
+        sources.erase(std::unique(sources.begin(), sources.end()), sources.end());
+
+        // Residual of x on the new graph: remove the old out-edges of the sources and add the new ones
+        double uniform = 0;
+        for (long u : sources) {
+            add_out_contribution(G, u, -x[u], W, uniform);
+        }
+        for (auto &e : deletions) G.delete_edge(e.first, e.second);
+        for (auto &e : insertions) G.insert_edge(e.first, e.second);
+        for (long u : sources) {
+            add_out_contribution(G, u, x[u], W, uniform);
+        }
+
+        auto enqueue = [&](long u) {
+            long degree = std::max<long>(G.OUT_DEGREE[u], 1);
+            if (!W.queued[u] && std::abs(W.residual[u]) > epsilon * degree) {
+                W.queued[u] = 1;
+                W.queue.push_back(u);
+            }
+        };
+
+        for (size_t i = 0; i < W.touched.size(); i++) {
+            enqueue(W.touched[i]);
+        }
+
+        // Push the residual
+        bool rescale = uniform != 0;
+        long pushes = 0;
+        for (size_t head = 0; head < W.queue.size(); head++) {
+            long u = W.queue[head];
+            W.queued[u] = 0;
+
+            double r = W.residual[u];
+            W.residual[u] = 0;
+            x[u] += r;
+            pushes++;
+
+            if (G.OUT_DEGREE[u] == 0) {
+                uniform += 0.85 * r / G.n;
+                rescale = true;
+                continue;
+            }
+
+            double share = 0.85 * r / G.OUT_DEGREE[u];
+            G.for_each_out_edge(u, [&](long v) {
+                if (W.residual[v] == 0) W.touched.push_back(v);
+                W.residual[v] += share;
+                enqueue(v);
+            });
+        }
+
+        // Keep the nodes with a residual left, once each, for the next update
+        size_t kept = 0;
+        for (long u : W.touched) {
+            if (W.residual[u] != 0 && !W.queued[u]) {
+                W.queued[u] = 1;
+                W.touched[kept++] = u;
+            }
+        }
+        W.touched.resize(kept);
+        for (long u : W.touched) {
+            W.queued[u] = 0;
+        }
+        W.queue.clear();
+
+        // The residual is scaled with the ranks, so it stays the error of the normalized vector
+        if (rescale) {
+            double sum = 0;
+            for (double value : x) sum += value;
+            for (double &value : x) value /= sum;
+            for (long u : W.touched) W.residual[u] /= sum;
+        }
+
+        G.maybe_compact();
+        return pushes;
+    }
+}
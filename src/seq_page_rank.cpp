@@ -1,3 +1,5 @@
+#pragma once
+
 #include <iostream>
 #include <fstream>
 #include <vector>
@@ -7,25 +9,81 @@
 #include <chrono>
 #include <cmath>
 #include <numeric>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <ctime>
+#include <cstdio>
 
 #include "../datagen/seq_csc_matrix.cpp"
+#include "rank_file.cpp"
+#include "telemetry.cpp"
 
 namespace sequential {
+
+    // ------------------ Options ------------------
+
+    /**
+     * @brief The iterative method used to solve the Page Rank system.
+     */
+    enum class Solver {
+        POWER,        // Power iteration: every iteration is computed from the previous one only
+        GAUSS_SEIDEL  // In-place updates in row order, using the values already updated in the same sweep
+    };
+
+    /**
+     * @brief The multiplication kernel used by the power method.
+     */
+    enum class Kernel {
+        SCATTER,              // Every edge adds its contribution directly into the output vector
+        PROPAGATION_BLOCKING  // The contributions are first binned by destination range, then accumulated bin by bin
+    };
+
+    /**
+     * @brief The extrapolation applied periodically to the iterates of the power method (Kamvar et al.).
+     */
+    enum class Extrapolation {
+        NONE,
+        AITKEN,     // Component-wise Aitken Delta^2 on the last three iterates
+        QUADRATIC   // Quadratic extrapolation on the last four iterates
+    };
+
+    /**
+     * @struct Page_Rank_Options
+     * @brief The parameters of a Page Rank solve.
+     */
+    struct Page_Rank_Options {
+        Solver solver = Solver::POWER;
+        Kernel kernel = Kernel::SCATTER;
+        long bin_rows = 1 << 16;    // The destination rows of every bin for the propagation blocking kernel, a power of two
+        Extrapolation extrapolation = Extrapolation::NONE;
+        int extrapolation_interval = 10;  // The power iterations between two extrapolations, at least 4
+        double tolerance = 1e-6;    // Stop when the norm of the difference between two iterates is below this
+        int *iterations = nullptr;  // If set, receives the number of iterations performed
+
+        const std::vector<double> *initial = nullptr;  // If set, the starting vector instead of a random one
+        const char *checkpoint_file = nullptr;         // If set, the iterate is saved here and the solve resumes from it
+        int checkpoint_interval = 10;                  // The number of iterations between two checkpoints
+        telemetry::Trace *trace = nullptr;             // If set, receives the statistics of every iteration
+    };
+
     
     // ------------------ Page Rank ------------------
 
     /**
-     * @brief Generates a random vector of the specified size.
+     * @brief Generates a random vector of the specified size, normalized to sum to one.
      * 
      * @param n The size of the vector.
+     * @param seed The seed of the generator. Defaults to the current time.
      * @return A pointer to the generated vector.
      */
-    std::vector<double>* gen_random_vector(long n) {
-        static std::vector<double> *v = new std::vector<double>(n);
+    std::vector<double>* gen_random_vector(long n, unsigned seed = std::time(0)) {
+        std::vector<double> *v = new std::vector<double>(n);
 
-        std::srand(std::time(0));
-        for (int i = 0; i < n; i++) {
-            (*v)[i] = (double)rand() / RAND_MAX;
+        std::mt19937 generator(seed);
+        std::uniform_real_distribution<double> distribution(0, 1);
+        for (long i = 0; i < n; i++) {
+            (*v)[i] = distribution(generator);
         }
 
         // Normalize the vector
@@ -42,43 +100,622 @@ namespace sequential {
     }
 
 
-    std::vector<double>* page_rank_iter(CSC_Matrix *M, std::vector<double> *v) {
+    /**
+     * @brief Returns the starting vector of a solve: the checkpoint if there is one, else the initial vector of the
+     * options, else a random vector.
+     * 
+     * @param n The number of nodes.
+     * @param options The options of the solve.
+     * @param iterations Receives the number of iterations already performed, non-zero only when resuming.
+     * @return A pointer to the starting vector.
+     */
+    std::vector<double>* starting_vector(long n, const Page_Rank_Options &options, int &iterations) {
+        iterations = 0;
+
+        if (options.checkpoint_file != nullptr && rank_file::exists(options.checkpoint_file)) {
+            return rank_file::load(options.checkpoint_file, &iterations, n);
+        }
+
+        if (options.initial == nullptr) {
+            return gen_random_vector(n);
+        }
+
+        if ((long)options.initial->size() != n) {
+            std::cout << "The initial vector does not match the graph" << std::endl;
+            exit(1);
+        }
+
+        std::vector<double> *x = new std::vector<double>(*options.initial);
+        double sum = std::accumulate(x->begin(), x->end(), 0.0);
+        for (long i = 0; i < n; i++) {
+            (*x)[i] /= sum;
+        }
+
+        return x;
+    }
+
+
+    /**
+     * @brief Saves the iterate to the checkpoint file of the options, every checkpoint_interval iterations.
+     */
+    inline void checkpoint(const Page_Rank_Options &options, const std::vector<double> &x, int iterations) {
+        if (options.checkpoint_file != nullptr && options.checkpoint_interval > 0 && iterations % options.checkpoint_interval == 0) {
+            rank_file::save(options.checkpoint_file, x, iterations);
+        }
+    }
+
+
+    /**
+     * @brief Removes the checkpoint file of the options once the solve has converged, so the next solve starts anew.
+     */
+    inline void finish_checkpoint(const Page_Rank_Options &options) {
+        if (options.checkpoint_file != nullptr) {
+            std::remove(options.checkpoint_file);
+        }
+    }
+
 
-        // std::cout << "Starting Page-Rank Iteration" << std::endl;
-        
+    /**
+     * @brief Performs a single iteration of the Page Rank algorithm.
+     * 
+     * @param M The matrix, either a CSC_Matrix or a snapshot::Mapped_CSC.
+     * @param v The input vector (len = n).
+     * @param output The vector where the result is written (len = n). It must not overlap v.
+     */
+    template <typename Matrix>
+    void page_rank_iter(Matrix *M, const double *v, double *output) {
         // Calculate the sum of the contribution of the dangling ends
         double sum = 0;
-        for (int i = 0; i < M->num_null_cols; i++) {
-            sum += (*v)[M->indexes_null_cols[i]]/M->n;
-        }    
+        for (long i = 0; i < M->num_null_cols; i++) {
+            sum += v[M->indexes_null_cols[i]]/M->n;
+        }
 
-        // std::cout << "Sum: " << sum << std::endl;
-        
-        std::vector<double> *output = new std::vector<double>(M->n, 0.85*sum+0.15/M->n);
+        std::fill(output, output + M->n, 0.85*sum+0.15/M->n);
 
         // Matrix multiplication
         for (long i = 0; i < M->n; i++) {
+            if (M->COL_PTR[i] == M->COL_PTR[i + 1]) continue;
+
+            double c = 0.85 * v[i] / M->OUT_DEGREE[i];
             for (long j = M->COL_PTR[i]; j < M->COL_PTR[i + 1]; j++) {
-                (*output)[M->ROW_INDEX[j]] += 0.85 * (*v)[i] / M->OUT_DEGREE[i];
+                output[M->ROW_INDEX[j]] += c;
             }
         }
+    }
 
-        return output;
+    /**
+     * @brief Computes the contribution v[i]/OUT_DEGREE[i] of every node, as used by page_rank_iter_fused.
+     * 
+     * @param M The matrix, either a CSC_Matrix or a snapshot::Mapped_CSC.
+     * @param v The rank vector (len = n).
+     * @param contrib The vector where the contributions are written (len = n).
+     * @return The dangling mass, i.e. the sum of v over the nodes with no out-edges.
+     */
+    template <typename Matrix>
+    double prepare_contrib(Matrix *M, const double *v, double *contrib) {
+        double dangling = 0;
+        for (long i = 0; i < M->n; i++) {
+            if (M->OUT_DEGREE[i] != 0) {
+                contrib[i] = v[i] / M->OUT_DEGREE[i];
+            } else {
+                contrib[i] = 0;
+                dangling += v[i];
+            }
+        }
+
+        return dangling;
+    }
+
+    /**
+     * @brief Applies the damping and the teleport to the output of a multiplication, in a single pass that also
+     * computes the norm of the difference and the contributions and dangling mass for the next iteration, and clears
+     * v, which is the output buffer of the next iteration.
+     * 
+     * @param M The matrix, either a CSC_Matrix or a snapshot::Mapped_CSC.
+     * @param v The input vector (len = n). It is set to zero.
+     * @param output The sums of the contributions of every row, replaced with the new ranks (len = n).
+     * @param contrib The contributions of v, replaced with the ones of the output (len = n).
+     * @param dangling The dangling mass of v, replaced with the one of the output.
+     * @return The norm of the difference between the output and v.
+     */
+    template <typename Matrix>
+    double page_rank_finalize(Matrix *M, double *v, double *output, double *contrib, double &dangling) {
+        double base = 0.85*dangling/M->n + 0.15/M->n;
+        double norm = 0, next_dangling = 0;
+
+        for (long r = 0; r < M->n; r++) {
+            double x = 0.85*output[r] + base;
+            double d = x - v[r];
+            norm += d*d;
+
+            output[r] = x;
+            v[r] = 0;
+
+            if (M->OUT_DEGREE[r] != 0) {
+                contrib[r] = x / M->OUT_DEGREE[r];
+            } else {
+                contrib[r] = 0;
+                next_dangling += x;
+            }
+        }
+
+        dangling = next_dangling;
+        return sqrt(norm);
+    }
+
+    /**
+     * @brief Adds the contribution of every column to the rows of its edges.
+     * 
+     * @param M The matrix, either a CSC_Matrix or a snapshot::Mapped_CSC.
+     * @param output The vector where the sums are added (len = n).
+     * @param contrib The contributions of every column (len = n).
+     */
+    template <typename Matrix>
+    void page_rank_scatter(Matrix *M, double *output, const double *contrib) {
+        for (long i = 0; i < M->n; i++) {
+            double c = contrib[i];
+            for (long j = M->COL_PTR[i]; j < M->COL_PTR[i + 1]; j++) {
+                output[M->ROW_INDEX[j]] += c;
+            }
+        }
     }
 
-    std::vector<double>* Page_Rank(CSC_Matrix *M) {
-        std::vector<double> *result, *temp = gen_random_vector(M->n);
+    /**
+     * @brief Performs a single iteration of the Page Rank algorithm, fused with the norm and the dangling sum.
+     * 
+     * The iteration makes two passes: the multiplication scatters the contributions into the output, then
+     * page_rank_finalize makes a single pass over the rows.
+     * 
+     * @param M The matrix, either a CSC_Matrix or a snapshot::Mapped_CSC.
+     * @param v The input vector (len = n). It is set to zero.
+     * @param output The vector where the result is written (len = n). It must be zero on entry.
+     * @param contrib The contributions of v, replaced with the ones of the output (len = n).
+     * @param dangling The dangling mass of v, replaced with the one of the output.
+     * @return The norm of the difference between the output and v.
+     */
+    template <typename Matrix>
+    double page_rank_iter_fused(Matrix *M, double *v, double *output, double *contrib, double &dangling) {
+        page_rank_scatter(M, output, contrib);
+        return page_rank_finalize(M, v, output, contrib, dangling);
+    }
+
+
+    // ------------------ Propagation blocking ------------------
+
+    /**
+     * @struct Propagation_Blocking
+     * @brief The bins of the propagation blocking kernel for a given matrix.
+     *
+     * The rows are split in bins of bin_rows consecutive destinations, small enough for their part of the output to
+     * stay in cache. The edges are grouped by bin once, keeping in every bin the destination of each edge as an offset
+     * from the first row of the bin; every iteration then only writes the contributions in the same order.
+     */
+    struct Propagation_Blocking {
+        long bin_rows, num_bins;
+        int bin_shift;                      // bin_rows = 2^bin_shift
+        std::vector<long> BIN_PTR;          // len = num_bins + 1, the first edge of every bin
+        std::vector<uint32_t> BIN_OFFSET;   // len = NNZ, the destination of every binned edge minus the first row of its bin
+        std::vector<double> BIN_VALUE;      // len = NNZ, the contribution of every binned edge
+        std::vector<long> cursor;           // len = num_bins, scratch space for the binning
+
+
+        /**
+         * @brief Groups the edges of a matrix by destination bin.
+         *
+         * @param M The matrix, either a CSC_Matrix or a snapshot::Mapped_CSC.
+         * @param rows The number of destination rows of every bin, rounded down to a power of two.
+         */
+        template <typename Matrix>
+        Propagation_Blocking(Matrix *M, long rows) {
+            if (rows <= 0 || rows > (1L << 32)) {
+                std::cout << "Invalid number of rows per bin: " << rows << std::endl;
+                exit(1);
+            }
+
+            bin_shift = 0;
+            while ((2L << bin_shift) <= rows) bin_shift++;
+            bin_rows = 1L << bin_shift;
+
+            num_bins = (M->n + bin_rows - 1) / bin_rows;
+            BIN_PTR.assign(num_bins + 1, 0);
+            for (long j = 0; j < M->NNZ; j++) {
+                BIN_PTR[(M->ROW_INDEX[j] >> bin_shift) + 1]++;
+            }
+            for (long b = 0; b < num_bins; b++) {
+                BIN_PTR[b + 1] += BIN_PTR[b];
+            }
+
+            BIN_OFFSET.resize(M->NNZ);
+            BIN_VALUE.resize(M->NNZ);
+            cursor.assign(BIN_PTR.begin(), BIN_PTR.end() - 1);
+            for (long i = 0; i < M->n; i++) {
+                for (long j = M->COL_PTR[i]; j < M->COL_PTR[i + 1]; j++) {
+                    long r = M->ROW_INDEX[j];
+                    BIN_OFFSET[cursor[r >> bin_shift]++] = r & (bin_rows - 1);
+                }
+            }
+        }
+    };
+
+    /**
+     * @brief Adds the contribution of every column to the rows of its edges with the propagation blocking kernel.
+     * 
+     * The first phase streams the columns and appends the contribution of every edge to the bin of its destination,
+     * so the writes go to num_bins sequential streams instead of random rows. The second phase accumulates the bins
+     * one at a time, with random writes confined to bin_rows rows of the output.
+     * 
+     * @param M The matrix, either a CSC_Matrix or a snapshot::Mapped_CSC.
+     * @param B The bins of M.
+     * @param output The vector where the sums are added (len = n).
+     * @param contrib The contributions of every column (len = n).
+     */
+    template <typename Matrix>
+    void page_rank_propagate_blocked(Matrix *M, Propagation_Blocking &B, double *output, const double *contrib) {
+        // Binning: the edges of every bin are in column order, as when the bins were built
+        std::copy(B.BIN_PTR.begin(), B.BIN_PTR.end() - 1, B.cursor.begin());
+        for (long i = 0; i < M->n; i++) {
+            double c = contrib[i];
+            for (long j = M->COL_PTR[i]; j < M->COL_PTR[i + 1]; j++) {
+                B.BIN_VALUE[B.cursor[M->ROW_INDEX[j] >> B.bin_shift]++] = c;
+            }
+        }
+
+        // Accumulation, one bin at a time
+        for (long b = 0; b < B.num_bins; b++) {
+            double *rows = output + b*B.bin_rows;
+            for (long k = B.BIN_PTR[b]; k < B.BIN_PTR[b + 1]; k++) {
+                rows[B.BIN_OFFSET[k]] += B.BIN_VALUE[k];
+            }
+        }
+    }
+
+    /**
+     * @brief Performs a single iteration of the Page Rank algorithm with the propagation blocking kernel.
+     *
+     * The multiplication is page_rank_propagate_blocked; the rest of the iteration is the same as page_rank_iter_fused.
+     * 
+     * @param M The matrix, either a CSC_Matrix or a snapshot::Mapped_CSC.
+     * @param B The bins of M.
+     * @param v The input vector (len = n). It is set to zero.
+     * @param output The vector where the result is written (len = n). It must be zero on entry.
+     * @param contrib The contributions of v, replaced with the ones of the output (len = n).
+     * @param dangling The dangling mass of v, replaced with the one of the output.
+     * @return The norm of the difference between the output and v.
+     */
+    template <typename Matrix>
+    double page_rank_iter_blocked(Matrix *M, Propagation_Blocking &B, double *v, double *output, double *contrib, double &dangling) {
+        page_rank_propagate_blocked(M, B, output, contrib);
+        return page_rank_finalize(M, v, output, contrib, dangling);
+    }
+
+    /**
+     * @brief Performs a Gauss-Seidel sweep of the Page Rank algorithm on the transposed matrix.
+     * 
+     * The rows are updated in place, in order, and the contribution and dangling mass of every updated row are used
+     * immediately by the following rows of the same sweep. Unlike the power method, the in-place updates do not keep
+     * the sum of the ranks equal to one, and the error on the sum would only decay by a factor 0.85 per sweep, so the
+     * vector is normalized at the end of every sweep.
+     * 
+     * @param T The transposed matrix.
+     * @param x The rank vector, updated in place (len = n).
+     * @param contrib The contributions of x, kept up to date (len = n).
+     * @param dangling The dangling mass of x, kept up to date.
+     * @return The norm of the difference between x before and after the sweep.
+     */
+    double page_rank_sweep_gauss_seidel(CSR_Matrix *T, double *x, double *contrib, double &dangling) {
+        double norm = 0, sum = 0;
+
+        for (long r = 0; r < T->n; r++) {
+            double acc = 0;
+            for (long j = T->ROW_PTR[r]; j < T->ROW_PTR[r + 1]; j++) {
+                acc += contrib[T->COL_INDEX[j]];
+            }
+
+            double value = 0.85*acc + 0.85*dangling/T->n + 0.15/T->n;
+            double d = value - x[r];
+            norm += d*d;
+            sum += value;
+            x[r] = value;
+
+            if (T->OUT_DEGREE[r] != 0) {
+                contrib[r] = value / T->OUT_DEGREE[r];
+            } else {
+                dangling += d;
+            }
+        }
+
+        for (long r = 0; r < T->n; r++) {
+            x[r] /= sum;
+            contrib[r] /= sum;
+        }
+        dangling /= sum;
+
+        return sqrt(norm);
+    }
+
+    /**
+     * @brief Performs the Page Rank algorithm with Gauss-Seidel sweeps on the transposed matrix.
+     * 
+     * @param T The transposed matrix.
+     * @param options The tolerance, the starting vector, the checkpoints and the output for the number of iterations.
+     *                The solver is ignored.
+     * @return A pointer to the final Page Rank vector.
+     */
+    std::vector<double>* Page_Rank_Gauss_Seidel(CSR_Matrix *T, Page_Rank_Options options = Page_Rank_Options()) {
+        int iterations;
+        std::vector<double> *x = starting_vector(T->n, options, iterations);
+        std::vector<double> contrib(T->n);
+
+        double dangling = prepare_contrib(T, x->data(), contrib.data());
+
+        if (options.trace != nullptr) {
+            options.trace->start("sequential_gauss_seidel", T->n, T->NNZ, 1, telemetry::bytes_per_iteration(T->n, T->NNZ));
+        }
+
+        double norm = 1;
+        while (norm >= options.tolerance) {
+            telemetry::Clock::time_point start = telemetry::Clock::now();
+            norm = page_rank_sweep_gauss_seidel(T, x->data(), contrib.data(), dangling);
+            telemetry::Clock::time_point swept = telemetry::Clock::now();
+            iterations++;
+
+            checkpoint(options, *x, iterations);
+
+            // The sweep fuses the multiplication with the rest of the iteration, so it is all counted as spmv
+            if (options.trace != nullptr) {
+                telemetry::Iteration_Stats s;
+                s.iteration = iterations;
+                s.residual = norm;
+                s.dangling = dangling;
+                s.spmv_seconds = telemetry::seconds(start, swept);
+                s.seconds = telemetry::seconds(start, telemetry::Clock::now());
+                options.trace->record(s);
+            }
+        }
+
+        finish_checkpoint(options);
+        if (options.iterations != nullptr) *options.iterations = iterations;
+        return x;
+    }
+
+    // ------------------ Extrapolation ------------------
+
+    /**
+     * @brief Rescales a vector that approximates the ranks to a probability vector, clearing the negative entries that
+     * an extrapolation can produce.
+     */
+    inline void normalize_ranks(long n, double *x) {
+        double sum = 0;
+        for (long i = 0; i < n; i++) {
+            if (x[i] < 0) x[i] = 0;
+            sum += x[i];
+        }
+        for (long i = 0; i < n; i++) {
+            x[i] /= sum;
+        }
+    }
+
+    /**
+     * @brief Replaces the last iterate with its component-wise Aitken extrapolation.
+     * 
+     * Every component is x2 - g^2/h, with g = x1 - x2 and h = x - 2*x1 + x2, which removes the error along the second
+     * eigenvector when it dominates. Components with h close to zero have already converged and are kept.
+     * 
+     * @param n The size of the vectors.
+     * @param x2 The iterate k - 2.
+     * @param x1 The iterate k - 1.
+     * @param x The iterate k, replaced with the extrapolation.
+     */
+    void aitken_extrapolation(long n, const double *x2, const double *x1, double *x) {
+        for (long i = 0; i < n; i++) {
+            double g = x1[i] - x2[i];
+            double h = x[i] - 2*x1[i] + x2[i];
+            if (std::abs(h) > 1e-14 * std::abs(x[i])) {
+                x[i] = x2[i] - g*g/h;
+            }
+        }
+
+        normalize_ranks(n, x);
+    }
+
+    /**
+     * @brief Replaces the last iterate with its quadratic extrapolation.
+     * 
+     * Assuming the iterates are combinations of the first three eigenvectors, the coefficients gamma of the
+     * characteristic polynomial of the iteration on that subspace are found by least squares on the differences
+     * y1 = x2 - x3, y2 = x1 - x3, y = x - x3 (solving [y1 y2] [g1 g2]^T = -y with g3 = 1), and the extrapolation is
+     * (g1+g2+g3) x2 + (g2+g3) x1 + g3 x.
+     * 
+     * @param n The size of the vectors.
+     * @param x3 The iterate k - 3.
+     * @param x2 The iterate k - 2.
+     * @param x1 The iterate k - 1.
+     * @param x The iterate k, replaced with the extrapolation.
+     */
+    void quadratic_extrapolation(long n, const double *x3, const double *x2, const double *x1, double *x) {
+        // Normal equations of the 2x2 least squares problem
+        double a11 = 0, a12 = 0, a22 = 0, b1 = 0, b2 = 0;
+        for (long i = 0; i < n; i++) {
+            double y1 = x2[i] - x3[i], y2 = x1[i] - x3[i], y = x[i] - x3[i];
+            a11 += y1*y1;
+            a12 += y1*y2;
+            a22 += y2*y2;
+            b1 -= y1*y;
+            b2 -= y2*y;
+        }
+
+        double det = a11*a22 - a12*a12;
+        if (std::abs(det) <= 1e-14 * a11 * a22) return;   // The differences are (nearly) parallel
+
+        double g1 = (b1*a22 - b2*a12) / det;
+        double g2 = (a11*b2 - a12*b1) / det;
+        double g3 = 1;
+
+        double beta0 = g1 + g2 + g3, beta1 = g2 + g3, beta2 = g3;
+        for (long i = 0; i < n; i++) {
+            x[i] = beta0*x2[i] + beta1*x1[i] + beta2*x[i];
+        }
+
+        normalize_ranks(n, x);
+    }
+
+
+    /**
+     * @struct Extrapolation_History
+     * @brief The previous iterates needed by the extrapolation, in buffers allocated once per solve.
+     * 
+     * The iterates are only copied during the last steps before every extrapolation, so the other iterations cost
+     * nothing.
+     */
+    struct Extrapolation_History {
+        Extrapolation method;
+        int interval, steps;
+        int since = 0;                             // The iterations since the start or the last extrapolation
+        std::vector<std::vector<double>> iterates; // iterates[0] is the oldest
+
+        Extrapolation_History(long n, Extrapolation method, int interval)
+            : method(method), interval(interval), steps(method == Extrapolation::QUADRATIC ? 3 : 2) {
+            if (method == Extrapolation::NONE) return;
+            if (interval <= steps) {
+                std::cout << "The extrapolation interval must be at least " << steps + 1 << std::endl;
+                exit(1);
+            }
+            iterates.assign(steps, std::vector<double>(n));
+        }
+
+        /**
+         * @brief Records the new iterate, and replaces it with its extrapolation when the interval is over.
+         * 
+         * @param x The new iterate (len = n).
+         * @return Whether x was extrapolated.
+         */
+        bool step(std::vector<double> &x) {
+            if (method == Extrapolation::NONE) return false;
+
+            since++;
+            if (since < interval) {
+                int slot = since - (interval - steps);
+                if (slot >= 0) std::copy(x.begin(), x.end(), iterates[slot].begin());
+                return false;
+            }
+
+            since = 0;
+            if (method == Extrapolation::AITKEN) {
+                aitken_extrapolation(x.size(), iterates[0].data(), iterates[1].data(), x.data());
+            } else {
+                quadratic_extrapolation(x.size(), iterates[0].data(), iterates[1].data(), iterates[2].data(), x.data());
+            }
+            return true;
+        }
+    };
+
+
+    /**
+     * @brief Performs the Page Rank algorithm.
+     * 
+     * With the power method the two vectors are allocated once and swapped at every iteration, so the iterations do
+     * not allocate any memory; the propagation blocking kernel builds its bins once before the first iteration, and the
+     * extrapolation allocates its history of iterates once. The Gauss-Seidel method first transposes the matrix.
+     * 
+     * @param M The matrix, either a CSC_Matrix or a snapshot::Mapped_CSC.
+     * @param options The solver, the tolerance, the starting vector and the checkpoints. Defaults to the power method
+     *                with tolerance 1e-6 from a random vector. When a checkpoint file is set and exists, the solve resumes
+     *                from it, and it is removed once the solve converges.
+     * @return A pointer to the final Page Rank vector.
+     */
+    template <typename Matrix>
+    std::vector<double>* Page_Rank(Matrix *M, Page_Rank_Options options = Page_Rank_Options()) {
+        if (options.solver == Solver::GAUSS_SEIDEL) {
+            CSR_Matrix T(M);
+            return Page_Rank_Gauss_Seidel(&T, options);
+        }
+
+        int iterations;
+        std::vector<double> *temp = starting_vector(M->n, options, iterations);
+        std::vector<double> *result = new std::vector<double>(M->n, 0);
+        std::vector<double> contrib(M->n);
+
+        double dangling = prepare_contrib(M, temp->data(), contrib.data());
+
+        Propagation_Blocking *B = nullptr;
+        if (options.kernel == Kernel::PROPAGATION_BLOCKING) {
+            B = new Propagation_Blocking(M, options.bin_rows);
+        }
+
+        Extrapolation_History history(M->n, options.extrapolation, options.extrapolation_interval);
+
+        if (options.trace != nullptr) {
+            options.trace->start(B != nullptr ? "sequential_power_blocked" : "sequential_power", M->n, M->NNZ, 1,
+                                 telemetry::bytes_per_iteration(M->n, M->NNZ, sizeof(M->ROW_INDEX[0])));
+        }
 
         double norm = 1;
-        while (norm >= 1e-6) {
-            result = page_rank_iter(M, temp);
+        while (norm >= options.tolerance) {
+            telemetry::Clock::time_point start = telemetry::Clock::now();
+            if (B != nullptr) {
+                page_rank_propagate_blocked(M, *B, result->data(), contrib.data());
+            } else {
+                page_rank_scatter(M, result->data(), contrib.data());
+            }
+            telemetry::Clock::time_point multiplied = telemetry::Clock::now();
+            norm = page_rank_finalize(M, temp->data(), result->data(), contrib.data(), dangling);
+            telemetry::Clock::time_point finalized = telemetry::Clock::now();
+            iterations++;
 
-            // Norm of the difference
-            norm = sqrt(inner_product(result->begin(), result->end(), temp->begin(), 0.0, std::plus<>(), [](double a, double b) { return (a - b) * (a - b); }));
+            std::swap(temp, result);
 
-            temp = result;
+            // The iterate that converged is returned as is: an extrapolation is only accepted after the power step
+            // that follows it has passed the tolerance test
+            if (norm >= options.tolerance && history.step(*temp)) {
+                dangling = prepare_contrib(M, temp->data(), contrib.data());
+            }
+
+            checkpoint(options, *temp, iterations);
+
+            if (options.trace != nullptr) {
+                telemetry::Iteration_Stats s;
+                s.iteration = iterations;
+                s.residual = norm;
+                s.dangling = dangling;
+                s.spmv_seconds = telemetry::seconds(start, multiplied);
+                s.finalize_seconds = telemetry::seconds(multiplied, finalized);
+                s.seconds = telemetry::seconds(start, telemetry::Clock::now());
+                options.trace->record(s);
+            }
         }
 
-        return result;
+        finish_checkpoint(options);
+        if (options.iterations != nullptr) *options.iterations = iterations;
+
+        delete B;
+        delete result;
+        return temp;
+    }
+
+
+    /**
+     * @brief Performs the Page Rank algorithm and returns the ranks with the statistics of every iteration.
+     * 
+     * @param M The matrix, either a CSC_Matrix or a snapshot::Mapped_CSC.
+     * @param options The parameters of the solve, as for Page_Rank. The trace and the output for the number of
+     *                iterations are ignored.
+     * @param on_iteration If set, called after every iteration with its statistics.
+     * @return The ranks, the number of iterations, the time of the solve and its trace.
+     */
+    template <typename Matrix>
+    telemetry::Page_Rank_Result Page_Rank_Traced(Matrix *M, Page_Rank_Options options = Page_Rank_Options(),
+                                                 telemetry::Iteration_Callback on_iteration = nullptr) {
+        telemetry::Page_Rank_Result r;
+        r.trace.on_iteration = on_iteration;
+        options.trace = &r.trace;
+        options.iterations = &r.iterations;
+
+        telemetry::Clock::time_point start = telemetry::Clock::now();
+        std::vector<double> *x = Page_Rank(M, options);
+        r.seconds = telemetry::seconds(start, telemetry::Clock::now());
+
+        r.ranks = std::move(*x);
+        delete x;
+        return r;
     }
-}
\ No newline at end of file
+}
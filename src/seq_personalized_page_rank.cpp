@@ -0,0 +1,122 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include "seq_page_rank.cpp"
+
+// ------------------ Local personalized Page Rank ------------------
+// The forward push of Andersen, Chung and Lang approximates the personalized Page Rank of a single seed by moving
+// probability mass from a residual vector to the rank vector, one node at a time, only where the residual is large.
+// The work depends on epsilon and on the neighbourhood of the seed, not on the size of the graph.
+
+
+namespace sequential {
+
+    /**
+     * @struct Local_Push_Workspace
+     * @brief The scratch buffers of the forward push, reused across queries.
+     *
+     * The dense arrays are allocated once for the whole graph and are kept at zero between queries: every query
+     * records the nodes it touches and clears only those, so a query never costs O(n).
+     */
+    struct Local_Push_Workspace {
+        std::vector<double> rank;                     // len = n
+        std::vector<double> residual;                 // len = n
+        std::vector<char> queued;                     // len = n, whether the node is in the queue
+        std::vector<long> touched;                    // The nodes with a non-zero rank or residual
+        std::vector<long> queue;                      // The nodes waiting to be pushed, from head onwards
+        std::vector<std::pair<long, double>> result;  // The ranks of the last query
+
+        explicit Local_Push_Workspace(long n) : rank(n, 0), residual(n, 0), queued(n, 0) {}
+
+        /**
+         * @brief Clears the touched entries, such as the residual carried across updates by Page_Rank_Update.
+         */
+        void clear() {
+            for (long u : touched) {
+                rank[u] = 0;
+                residual[u] = 0;
+            }
+            touched.clear();
+            queue.clear();
+        }
+    };
+
+
+    /**
+     * @brief Computes an approximate personalized Page Rank of a single seed with the forward push.
+     *
+     * A node u is pushed while its residual is above epsilon * OUT_DEGREE[u]: (1 - damping) of the residual is added
+     * to its rank and the rest is split among its out-neighbours. The residual of a dangling node goes back to the seed,
+     * as the random surfer teleports from it. When the queue is empty every residual is below epsilon times the out
+     * degree, so the error of each rank is at most epsilon times the sum of the out degrees of its in-neighbours.
+     *
+     * @param M The matrix, either a CSC_Matrix or a snapshot::Mapped_CSC.
+     * @param seed The seed node.
+     * @param epsilon The residual threshold per out-edge.
+     * @param W The workspace, created for the same matrix. A residual left by Page_Rank_Update is cleared first.
+     * @param damping The damping factor. Defaults to 0.85.
+     * @return A pointer to the non-zero ranks, as (node, rank) pairs sorted by node. It points into the workspace and
+     *         is only valid until the next query.
+     */
+    template <typename Matrix>
+    const std::vector<std::pair<long, double>>* Local_Page_Rank(Matrix *M, long seed, double epsilon, Local_Push_Workspace &W,
+                                                                double damping = 0.85) {
+        auto touch = [&](long u) {
+            if (W.rank[u] == 0 && W.residual[u] == 0) W.touched.push_back(u);
+        };
+
+        auto enqueue = [&](long u) {
+            long degree = std::max<long>(M->OUT_DEGREE[u], 1);
+            if (!W.queued[u] && W.residual[u] > epsilon * degree) {
+                W.queued[u] = 1;
+                W.queue.push_back(u);
+            }
+        };
+
+        W.clear();
+        touch(seed);
+        W.residual[seed] = 1;
+        enqueue(seed);
+
+        for (size_t head = 0; head < W.queue.size(); head++) {
+            long u = W.queue[head];
+            W.queued[u] = 0;
+
+            double r = W.residual[u];
+            W.residual[u] = 0;
+            W.rank[u] += (1 - damping) * r;
+
+            long degree = M->OUT_DEGREE[u];
+            if (degree == 0) {
+                W.residual[seed] += damping * r;
+                enqueue(seed);
+                continue;
+            }
+
+            double share = damping * r / degree;
+            for (long j = M->COL_PTR[u]; j < M->COL_PTR[u + 1]; j++) {
+                long v = M->ROW_INDEX[j];
+                touch(v);
+                W.residual[v] += share;
+                enqueue(v);
+            }
+        }
+
+        // Collect the ranks and clear the touched entries for the next query
+        W.result.clear();
+        std::sort(W.touched.begin(), W.touched.end());
+        for (long u : W.touched) {
+            if (W.rank[u] != 0) W.result.emplace_back(u, W.rank[u]);
+            W.rank[u] = 0;
+            W.residual[u] = 0;
+        }
+        W.touched.clear();
+        W.queue.clear();
+
+        return &W.result;
+    }
+}
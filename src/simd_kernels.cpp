@@ -0,0 +1,275 @@
+#pragma once
+
+#include <iostream>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+/**
+ * @namespace simd
+ * @brief Contains the vectorized kernels of the pull iteration on the transposed matrix, in a scalar, an AVX2 and an
+ * AVX-512 variant, and the dispatch that selects the best variant supported by the CPU at startup.
+ *
+ * The variants are compiled with target attributes, so the file needs no special compiler flags and the binary still
+ * runs on CPUs without AVX. The vector variants sum in a different order, so their results differ from the scalar one
+ * only by rounding. On other architectures only the scalar variant is compiled.
+ */
+namespace simd {
+
+    /**
+     * @brief The instruction sets with a kernel variant.
+     */
+    enum class Isa {
+        SCALAR,
+        AVX2,
+        AVX512
+    };
+
+    const char* isa_name(Isa isa) {
+        switch (isa) {
+            case Isa::AVX2: return "avx2";
+            case Isa::AVX512: return "avx512";
+            default: return "scalar";
+        }
+    }
+
+
+    /**
+     * @brief Checks with CPUID whether the CPU supports the given instruction set.
+     */
+    bool supported(Isa isa) {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_cpu_init();
+        switch (isa) {
+            case Isa::AVX2: return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+            case Isa::AVX512: return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq");
+            default: return true;
+        }
+#else
+        return isa == Isa::SCALAR;
+#endif
+    }
+
+
+    // ------------------ Scalar ------------------
+
+    /**
+     * @brief Sums the contributions of the given sources.
+     *
+     * @param index The sources (len = len).
+     * @param len The number of sources.
+     * @param contrib The contribution of every node.
+     * @return The sum of contrib over the sources.
+     */
+    double row_sum_scalar(const long *index, long len, const double *contrib) {
+        double acc = 0;
+        for (long j = 0; j < len; j++) {
+            acc += contrib[index[j]];
+        }
+        return acc;
+    }
+
+    /**
+     * @brief Turns the sums of the contributions of a range of rows into ranks, computing at the same time the norm
+     * of the difference and the contributions and dangling mass of the new ranks.
+     *
+     * All the pointers start at the first row of the range.
+     *
+     * @param len The number of rows.
+     * @param OUT_DEGREE The out degree of every row.
+     * @param v The previous ranks.
+     * @param result The sums of the contributions, replaced with the new ranks.
+     * @param next_contrib Where the contributions of the new ranks are written.
+     * @param base The teleport and dangling term added to every rank.
+     * @param dangling Receives the dangling mass of the range added to its value.
+     * @return The squared norm of the difference over the range.
+     */
+    double finalize_scalar(long len, const long *OUT_DEGREE, const double *v, double *result, double *next_contrib,
+                           double base, double &dangling) {
+        double norm = 0;
+        for (long r = 0; r < len; r++) {
+            double x = 0.85*result[r] + base;
+            double d = x - v[r];
+            norm += d*d;
+
+            result[r] = x;
+
+            if (OUT_DEGREE[r] != 0) {
+                next_contrib[r] = x / OUT_DEGREE[r];
+            } else {
+                next_contrib[r] = 0;
+                dangling += x;
+            }
+        }
+        return norm;
+    }
+
+
+#if defined(__x86_64__) || defined(__i386__)
+
+    // ------------------ AVX2 ------------------
+
+    __attribute__((target("avx2,fma")))
+    double row_sum_avx2(const long *index, long len, const double *contrib) {
+        __m256d acc = _mm256_setzero_pd();
+
+        long j = 0;
+        for (; j + 4 <= len; j += 4) {
+            __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(index + j));
+            acc = _mm256_add_pd(acc, _mm256_i64gather_pd(contrib, idx, 8));
+        }
+
+        __m128d half = _mm_add_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+        double sum = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+
+        for (; j < len; j++) {
+            sum += contrib[index[j]];
+        }
+        return sum;
+    }
+
+    __attribute__((target("avx2,fma")))
+    double finalize_avx2(long len, const long *OUT_DEGREE, const double *v, double *result, double *next_contrib,
+                         double base, double &dangling) {
+        const __m256d damping = _mm256_set1_pd(0.85), teleport = _mm256_set1_pd(base);
+        // AVX2 has no conversion from 64-bit integers: the degrees (below 2^52) are put in the mantissa of 2^52
+        const __m256i exponent = _mm256_set1_epi64x(0x4330000000000000);
+        const __m256d two_52 = _mm256_set1_pd(4503599627370496.0);
+        __m256d norm = _mm256_setzero_pd(), dangling_acc = _mm256_setzero_pd();
+
+        long r = 0;
+        for (; r + 4 <= len; r += 4) {
+            __m256d x = _mm256_fmadd_pd(damping, _mm256_loadu_pd(result + r), teleport);
+            __m256d d = _mm256_sub_pd(x, _mm256_loadu_pd(v + r));
+            norm = _mm256_fmadd_pd(d, d, norm);
+            _mm256_storeu_pd(result + r, x);
+
+            __m256i deg = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(OUT_DEGREE + r));
+            __m256d degree = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(deg, exponent)), two_52);
+            __m256d is_dangling = _mm256_castsi256_pd(_mm256_cmpeq_epi64(deg, _mm256_setzero_si256()));
+
+            _mm256_storeu_pd(next_contrib + r, _mm256_andnot_pd(is_dangling, _mm256_div_pd(x, degree)));
+            dangling_acc = _mm256_add_pd(dangling_acc, _mm256_and_pd(is_dangling, x));
+        }
+
+        double lanes[4], dangling_lanes[4];
+        _mm256_storeu_pd(lanes, norm);
+        _mm256_storeu_pd(dangling_lanes, dangling_acc);
+        dangling += (dangling_lanes[0] + dangling_lanes[1]) + (dangling_lanes[2] + dangling_lanes[3]);
+
+        return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3])
+             + finalize_scalar(len - r, OUT_DEGREE + r, v + r, result + r, next_contrib + r, base, dangling);
+    }
+
+
+    // ------------------ AVX-512 ------------------
+
+    __attribute__((target("avx512f")))
+    inline double reduce_add_avx512(__m512d x) {
+        double lanes[8];
+        _mm512_storeu_pd(lanes, x);
+        return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    }
+
+    __attribute__((target("avx512f,avx512dq")))
+    double row_sum_avx512(const long *index, long len, const double *contrib) {
+        __m512d acc = _mm512_setzero_pd();
+
+        long j = 0;
+        for (; j + 8 <= len; j += 8) {
+            __m512i idx = _mm512_loadu_si512(index + j);
+            acc = _mm512_add_pd(acc, _mm512_mask_i64gather_pd(_mm512_setzero_pd(), 0xFF, idx, contrib, 8));
+        }
+
+        if (j < len) {
+            __mmask8 mask = (1 << (len - j)) - 1;
+            __m512i idx = _mm512_maskz_loadu_epi64(mask, index + j);
+            acc = _mm512_add_pd(acc, _mm512_mask_i64gather_pd(_mm512_setzero_pd(), mask, idx, contrib, 8));
+        }
+
+        return reduce_add_avx512(acc);
+    }
+
+    __attribute__((target("avx512f,avx512dq")))
+    double finalize_avx512(long len, const long *OUT_DEGREE, const double *v, double *result, double *next_contrib,
+                           double base, double &dangling) {
+        const __m512d damping = _mm512_set1_pd(0.85), teleport = _mm512_set1_pd(base);
+        __m512d norm = _mm512_setzero_pd(), dangling_acc = _mm512_setzero_pd();
+
+        for (long r = 0; r < len; r += 8) {
+            __mmask8 mask = len - r >= 8 ? 0xFF : (1 << (len - r)) - 1;
+
+            __m512d x = _mm512_fmadd_pd(damping, _mm512_maskz_loadu_pd(mask, result + r), teleport);
+            __m512d d = _mm512_maskz_sub_pd(mask, x, _mm512_maskz_loadu_pd(mask, v + r));
+            norm = _mm512_fmadd_pd(d, d, norm);
+            _mm512_mask_storeu_pd(result + r, mask, x);
+
+            __m512i deg = _mm512_maskz_loadu_epi64(mask, OUT_DEGREE + r);
+            __mmask8 linked = _mm512_cmpneq_epi64_mask(deg, _mm512_setzero_si512());
+
+            _mm512_mask_storeu_pd(next_contrib + r, mask, _mm512_maskz_div_pd(linked, x, _mm512_cvtepi64_pd(deg)));
+            dangling_acc = _mm512_mask_add_pd(dangling_acc, mask & ~linked, dangling_acc, x);
+        }
+
+        dangling += reduce_add_avx512(dangling_acc);
+        return reduce_add_avx512(norm);
+    }
+
+#endif
+
+
+    // ------------------ Dispatch ------------------
+
+    /**
+     * @struct Kernels
+     * @brief The kernels of one instruction set.
+     */
+    struct Kernels {
+        Isa isa;
+        double (*row_sum)(const long *index, long len, const double *contrib);
+        double (*finalize)(long len, const long *OUT_DEGREE, const double *v, double *result, double *next_contrib,
+                           double base, double &dangling);
+    };
+
+    /**
+     * @brief Returns the kernels of the given instruction set, which must be supported.
+     */
+    Kernels kernels_for(Isa isa) {
+        switch (isa) {
+#if defined(__x86_64__) || defined(__i386__)
+            case Isa::AVX512: return {Isa::AVX512, row_sum_avx512, finalize_avx512};
+            case Isa::AVX2: return {Isa::AVX2, row_sum_avx2, finalize_avx2};
+#endif
+            default: return {Isa::SCALAR, row_sum_scalar, finalize_scalar};
+        }
+    }
+
+    /**
+     * @brief Returns the best instruction set supported by the CPU.
+     */
+    Isa detect_isa() {
+        if (supported(Isa::AVX512)) return Isa::AVX512;
+        if (supported(Isa::AVX2)) return Isa::AVX2;
+        return Isa::SCALAR;
+    }
+
+    /**
+     * @brief The kernels used by the solvers, selected once at startup.
+     */
+    Kernels active = kernels_for(detect_isa());
+
+    /**
+     * @brief Replaces the kernels used by the solvers, e.g. to compare the variants.
+     *
+     * @param isa The instruction set. It must be supported by the CPU.
+     */
+    void set_isa(Isa isa) {
+        if (!supported(isa)) {
+            std::cout << "Instruction set not supported: " << isa_name(isa) << std::endl;
+            exit(1);
+        }
+        active = kernels_for(isa);
+    }
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <functional>
+
+/**
+ * @namespace telemetry
+ * @brief Contains the per-iteration statistics of a solve, the optional callback called after every iteration, and
+ * the writers of the trace as JSON or CSV.
+ *
+ * The solvers only record a trace when Page_Rank_Options::trace is set; the timers themselves are a few clock reads
+ * per iteration.
+ */
+namespace telemetry {
+
+    typedef std::chrono::steady_clock Clock;
+
+
+    /**
+     * @brief Returns the seconds elapsed between two time points.
+     */
+    inline double seconds(Clock::time_point start, Clock::time_point end) {
+        return std::chrono::duration<double>(end - start).count();
+    }
+
+
+    /**
+     * @brief Returns the bytes that an iteration must move at least: every edge reads its index and one value, and
+     * every row reads its offset, its out degree and its old rank, and writes its new rank and contribution.
+     *
+     * @param n The number of nodes.
+     * @param NNZ The number of edges.
+     * @param index_bytes The size of an edge index.
+     */
+    inline double bytes_per_iteration(long n, long NNZ, size_t index_bytes = sizeof(long)) {
+        return (double)NNZ * (index_bytes + sizeof(double)) + (double)n * (2 * sizeof(long) + 3 * sizeof(double));
+    }
+
+
+    /**
+     * @struct Iteration_Stats
+     * @brief The statistics of a single iteration.
+     *
+     * The dangling sum and the norm are fused in the same pass as the damping and the teleport, so they are timed
+     * together as the finalize phase. With several threads the phases are the ones of the slowest thread, the wall time
+     * runs from the first thread to start the iteration, and sync is the rest of it, spent waiting at the barrier and
+     * adding up the partial sums.
+     */
+    struct Iteration_Stats {
+        int iteration = 0;            // The number of iterations performed, including the ones of a checkpoint
+        double residual = 0;          // The norm of the difference between the iterate and the previous one
+        double dangling = 0;          // The dangling mass of the new iterate
+        double spmv_seconds = 0;      // The multiplication
+        double finalize_seconds = 0;  // The damping, the teleport, the norm and the dangling sum
+        double sync_seconds = 0;      // The barriers and the reductions
+        double seconds = 0;           // The wall time of the whole iteration, extrapolation and checkpoint included
+        double edges_per_second = 0;
+        double gb_per_second = 0;     // bytes_per_iteration over the wall time
+    };
+
+    typedef std::function<void(const Iteration_Stats&)> Iteration_Callback;
+
+
+    /**
+     * @struct Trace
+     * @brief The statistics of every iteration of a solve.
+     */
+    struct Trace {
+        std::string solver;
+        long n = 0, NNZ = 0;
+        int threads = 1;
+        double bytes_per_iteration = 0;
+        std::vector<Iteration_Stats> iterations;
+        Iteration_Callback on_iteration;  // If set, called after every iteration with its statistics
+
+
+        /**
+         * @brief Clears the trace at the start of a solve.
+         */
+        void start(const std::string &solver_name, long nodes, long edges, int cores, double bytes) {
+            solver = solver_name;
+            n = nodes;
+            NNZ = edges;
+            threads = cores;
+            bytes_per_iteration = bytes;
+            iterations.clear();
+        }
+
+        /**
+         * @brief Completes the throughput of an iteration from its wall time, appends it and calls the callback.
+         */
+        void record(Iteration_Stats s) {
+            if (s.seconds > 0) {
+                s.edges_per_second = NNZ / s.seconds;
+                s.gb_per_second = bytes_per_iteration / s.seconds * 1e-9;
+            }
+
+            iterations.push_back(s);
+            if (on_iteration) on_iteration(s);
+        }
+
+        /**
+         * @brief Returns the sum of the wall times of the iterations.
+         */
+        double total_seconds() const {
+            double total = 0;
+            for (const Iteration_Stats &s : iterations) total += s.seconds;
+            return total;
+        }
+    };
+
+
+    /**
+     * @struct Page_Rank_Result
+     * @brief The result of a traced solve: the ranks and the trace of the iterations.
+     */
+    struct Page_Rank_Result {
+        std::vector<double> ranks;
+        int iterations = 0;  // Including the ones of a checkpoint, so possibly more than trace.iterations.size()
+        double seconds = 0;  // The wall time of the whole solve, setup included
+        Trace trace;
+    };
+
+
+    // ------------------ Output ------------------
+
+    /**
+     * @brief Writes an iteration as the fields of a JSON object.
+     */
+    void write_json_fields(std::ostream &out, const Iteration_Stats &s) {
+        out << "\"iteration\": " << s.iteration << ", \"residual\": " << s.residual << ", \"dangling\": " << s.dangling
+            << ", \"spmv_seconds\": " << s.spmv_seconds << ", \"finalize_seconds\": " << s.finalize_seconds
+            << ", \"sync_seconds\": " << s.sync_seconds << ", \"seconds\": " << s.seconds
+            << ", \"edges_per_second\": " << s.edges_per_second << ", \"gb_per_second\": " << s.gb_per_second;
+    }
+
+    /**
+     * @brief Writes a result as a JSON object, with the trace as an array of iterations.
+     *
+     * @param out The output stream.
+     * @param result The result of a traced solve.
+     */
+    void write_json(std::ostream &out, const Page_Rank_Result &result) {
+        const Trace &t = result.trace;
+        std::streamsize precision = out.precision(17);
+
+        out << "{\"solver\": \"" << t.solver << "\", \"n\": " << t.n << ", \"nnz\": " << t.NNZ << ", \"threads\": "
+            << t.threads << ", \"bytes_per_iteration\": " << t.bytes_per_iteration << ", \"iterations\": "
+            << result.iterations << ", \"seconds\": " << result.seconds << ", \"trace\": [";
+
+        for (size_t i = 0; i < t.iterations.size(); i++) {
+            out << (i == 0 ? "\n  {" : ",\n  {");
+            write_json_fields(out, t.iterations[i]);
+            out << "}";
+        }
+
+        out << "\n]}" << std::endl;
+        out.precision(precision);
+    }
+
+    /**
+     * @brief Writes the trace of a result as CSV, one line per iteration, with the solver and the number of threads
+     * on every line so that the traces of several solves can be concatenated.
+     *
+     * @param out The output stream.
+     * @param result The result of a traced solve.
+     * @param header Whether to write the header line first. Defaults to true.
+     */
+    void write_csv(std::ostream &out, const Page_Rank_Result &result, bool header = true) {
+        const Trace &t = result.trace;
+        std::streamsize precision = out.precision(17);
+
+        if (header) {
+            out << "solver,threads,iteration,residual,dangling,spmv_seconds,finalize_seconds,sync_seconds,seconds,"
+                   "edges_per_second,gb_per_second" << std::endl;
+        }
+
+        for (const Iteration_Stats &s : t.iterations) {
+            out << t.solver << "," << t.threads << "," << s.iteration << "," << s.residual << "," << s.dangling << ","
+                << s.spmv_seconds << "," << s.finalize_seconds << "," << s.sync_seconds << "," << s.seconds << ","
+                << s.edges_per_second << "," << s.gb_per_second << std::endl;
+        }
+
+        out.precision(precision);
+    }
+}
@@ -0,0 +1,154 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <cstdio>
+
+#include "../src/par_adaptive_page_rank.cpp"
+#include "../datagen/synthetic_graph.cpp"
+
+// Compares the adaptive solve, which stops recomputing the converged rows, with the full power method: time, work
+// and error against a reference solved to 1e-14. The times are the best of several runs. Instead of a file, "mixed"
+// generates a graph whose rows converge at very different rates (see write_mixed_graph).
+// g++ adaptive_benchmark.cpp -O3 -fopenmp -o adaptive_benchmark.exe
+
+
+/**
+ * @brief Returns the L1 distance and the maximum relative error of x against the reference.
+ */
+std::pair<double, double> errors(const std::vector<double> &x, const std::vector<double> &reference) {
+    double distance = 0, max_relative = 0;
+    for (size_t i = 0; i < x.size(); i++) {
+        double d = std::abs(x[i] - reference[i]);
+        distance += d;
+        max_relative = std::max(max_relative, d / reference[i]);
+    }
+    return {distance, max_relative};
+}
+
+
+/**
+ * @brief Writes a graph made of two parts with no edge between them: a dense uniform core of 2^16 nodes with edge
+ * factor 32, which converges in a few iterations, and a sparse periphery of 2^16 nodes, an R-MAT graph with edge
+ * factor 1 on top of a directed ring, which converges slowly. The ring leaves no dangling node, so the periphery does
+ * not move rank into the core through the teleport.
+ *
+ * @param filename The name of the output file.
+ * @param threads The number of threads of the generator.
+ */
+void write_mixed_graph(const char *filename, int threads) {
+    synthetic::Generator_Options core_options, periphery_options;
+    core_options.model = synthetic::Model::UNIFORM;
+    core_options.edge_factor = 32;
+    periphery_options.model = synthetic::Model::RMAT;
+    periphery_options.edge_factor = 1;
+    core_options.threads = periphery_options.threads = threads;
+    synthetic::Generator core(core_options), periphery(periphery_options);
+
+    long n = core.n + periphery.n;
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    file << "# Nodes: " << n << " Edges: " << core.NNZ + periphery.NNZ + periphery.n << "\n";
+
+    std::string out;
+    for (long b = 0; b < core.num_blocks; b++) {
+        core.generate_block(b, [&](long from, long to) { out += std::to_string(from) + "\t" + std::to_string(to) + "\n"; });
+    }
+    for (long b = 0; b < periphery.num_blocks; b++) {
+        periphery.generate_block(b, [&](long from, long to) {
+            out += std::to_string(core.n + from) + "\t" + std::to_string(core.n + to) + "\n";
+        });
+    }
+    for (long i = 0; i < periphery.n; i++) {
+        out += std::to_string(core.n + i) + "\t" + std::to_string(core.n + (i + 1) % periphery.n) + "\n";
+    }
+
+    file << out;
+}
+
+
+/**
+ * @brief Runs the given solver several times and returns the best time in ms, with the ranks of the last run.
+ */
+template <typename Solver>
+double best_time(int runs, Solver solver, std::vector<double> *&ranks) {
+    double best = INFINITY;
+    for (int i = 0; i < runs; i++) {
+        delete ranks;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        ranks = solver();
+        auto end = std::chrono::high_resolution_clock::now();
+
+        std::chrono::duration<double> elapsed = end - start;
+        best = std::min(best, elapsed.count() * 1e3);
+    }
+
+    return best;
+}
+
+
+int main(int argc, char *argv[]) {
+    if (argc < 3 || argc > 8) {
+        std::cout << "Usage: " << argv[0] << " <graph_file> <num_threads> [tolerance] [freeze_factor] [revalidate_interval] "
+                  << "[active_edges] [runs]" << std::endl;
+        return 1;
+    }
+
+    const bool mixed = std::string(argv[1]) == "mixed";
+    const char *filename = mixed ? "mixed.txt" : argv[1];
+    const int cores = atoi(argv[2]);
+    const double tolerance = argc >= 4 ? atof(argv[3]) : 1e-6;
+    parallel::Adaptive_Options adaptive_options;
+    if (argc >= 5) adaptive_options.freeze_factor = atof(argv[4]);
+    if (argc >= 6) adaptive_options.revalidate_interval = atoi(argv[5]);
+    if (argc >= 7) adaptive_options.active_edges = atof(argv[6]);
+    const int runs = argc == 8 ? atoi(argv[7]) : 5;
+
+    if (mixed) write_mixed_graph(filename, cores);
+    parallel::CSR_Matrix *M = parallel::load_graph_CSR(filename, cores);
+    if (mixed) std::remove(filename);
+    std::vector<double> *initial = parallel::gen_random_vector(M->n, 42);
+    std::cout << std::endl;
+
+    parallel::Page_Rank_Options options;
+    options.initial = initial;
+    options.tolerance = 1e-14;
+    std::vector<double> *reference = parallel::Page_Rank(M, cores, options);
+
+    options.tolerance = tolerance;
+    int iterations;
+    options.iterations = &iterations;
+
+    std::vector<double> *full = nullptr;
+    double full_time = best_time(runs, [&]() { return parallel::Page_Rank(M, cores, options); }, full);
+    std::pair<double, double> full_error = errors(*full, *reference);
+
+    std::cout << "full:     " << iterations << " iterations, " << (double)iterations * M->NNZ << " edges read, "
+              << full_time << " ms, L1 error " << full_error.first << ", max relative error " << full_error.second
+              << std::endl;
+
+    options.iterations = nullptr;
+    parallel::Adaptive_Report report;
+    std::vector<double> *adaptive = nullptr;
+    double adaptive_time = best_time(runs, [&]() {
+        return parallel::Page_Rank_Adaptive(M, cores, options, adaptive_options, &report);
+    }, adaptive);
+    std::pair<double, double> adaptive_error = errors(*adaptive, *reference);
+
+    std::cout << "adaptive: " << report.iterations << " iterations (" << report.full_iterations << " full), "
+              << (double)report.edge_updates << " edges read, " << adaptive_time << " ms, L1 error "
+              << adaptive_error.first << ", max relative error " << adaptive_error.second << std::endl;
+
+    std::cout << "speedup: " << full_time / adaptive_time << ", work: "
+              << (double)report.edge_updates / ((double)iterations * M->NNZ) << " of the full solve" << std::endl;
+
+    delete initial;
+    delete reference;
+    delete full;
+    delete adaptive;
+    delete M;
+    return 0;
+}
@@ -0,0 +1,172 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <new>
+#include <atomic>
+
+#include "../src/seq_page_rank.cpp"
+#include "../src/par_page_rank.cpp"
+
+// Checks that the Page Rank iterations, and the iterations of the whole solvers, do not allocate any memory once the
+// buffers exist.
+// g++ alloc_test.cpp -O3 -fopenmp -o alloc_test.exe
+
+
+// ------------------ Counting allocator ------------------
+
+static std::atomic<long> allocations(0);  // Also counts the allocations of the worker threads
+
+// Every form of new and delete goes through these two, which are never inlined: once free is inlined into the caller
+// of a delete, GCC sees it release memory from operator new and warns of a mismatch
+__attribute__((noinline)) void* counted_malloc(std::size_t size, std::size_t alignment = 0) {
+    allocations++;
+    if (alignment == 0) return std::malloc(size ? size : 1);
+
+    // aligned_alloc needs a size that is a multiple of the alignment
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+__attribute__((noinline)) void counted_free(void *p) noexcept { std::free(p); }
+
+void* operator new(std::size_t size) {
+    if (void *p = counted_malloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (void *p = counted_malloc(size, (std::size_t)alignment)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return counted_malloc(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return counted_malloc(size); }
+
+void operator delete(void *p) noexcept { counted_free(p); }
+void operator delete[](void *p) noexcept { counted_free(p); }
+void operator delete(void *p, std::size_t) noexcept { counted_free(p); }
+void operator delete[](void *p, std::size_t) noexcept { counted_free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { counted_free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { counted_free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { counted_free(p); }
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { counted_free(p); }
+void operator delete(void *p, const std::nothrow_t&) noexcept { counted_free(p); }
+void operator delete[](void *p, const std::nothrow_t&) noexcept { counted_free(p); }
+
+
+/**
+ * @brief Runs a warm-up iteration, then counts the allocations made by the following ones.
+ * 
+ * @return true if the iterations did not allocate.
+ */
+template <typename Iteration>
+bool check(const char *name, Iteration iteration) {
+    iteration(); // The first parallel region may allocate the thread pool
+
+    long before = allocations;
+    for (int i = 0; i < 20; i++) {
+        iteration();
+    }
+    long count = allocations - before;
+
+    std::cout << name << ": " << count << " allocations in 20 iterations" << std::endl;
+    return count == 0;
+}
+
+
+/**
+ * @brief Runs a whole solve with a trace, and counts the allocations made from the end of its first iteration to the
+ * end of its last one, as seen by the callback of the trace.
+ * 
+ * @param solve Solves with the given trace in its options and returns the ranks.
+ * @return true if the solve took more than one iteration and its later iterations did not allocate.
+ */
+template <typename Solve>
+bool check_solve(const char *name, Solve solve) {
+    const int max_iterations = 1000;
+    long after_first = 0, after_last = 0;
+    int seen = 0;
+
+    telemetry::Trace trace;
+    trace.iterations.reserve(max_iterations); // So that recording the iterations does not allocate
+    trace.on_iteration = [&](const telemetry::Iteration_Stats &) {
+        long now = allocations;
+        if (seen++ == 0) after_first = now;
+        after_last = now;
+    };
+
+    std::vector<double> *x = solve(&trace);
+    delete x;
+
+    long count = after_last - after_first;
+    std::cout << name << ": " << count << " allocations in " << seen - 1 << " iterations" << std::endl;
+    return seen > 1 && seen <= max_iterations && count == 0;
+}
+
+
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        std::cout << "Usage: " << argv[0] << " <graph_file> <num_threads>" << std::endl;
+        return 1;
+    }
+
+    const char *filename = argv[1];
+    const int cores = atoi(argv[2]);
+
+    sequential::CSC_Matrix *M = sequential::load_graph_CSC(filename);
+    std::vector<parallel::CSC_Matrix*> matrices = parallel::load_graph_CSC(filename, cores);
+    parallel::CSR_Matrix *T = parallel::load_graph_CSR(filename, cores);
+    std::cout << std::endl;
+
+    long n = M->n;
+    std::vector<double> v(n, 1.0 / n), result(n), contrib(n), next_contrib(n);
+    double dangling = 0;
+    std::vector<long> bounds = parallel::balanced_row_bounds(T->ROW_PTR.data(), n, cores);
+
+    bool ok = true;
+    ok &= check("sequential", [&]() { sequential::page_rank_iter(M, v.data(), result.data()); });
+    ok &= check("parallel CSC", [&]() { parallel::page_rank_iter(matrices, v.data(), result.data(), contrib.data(), cores); });
+    ok &= check("parallel CSR", [&]() { parallel::page_rank_iter(T, v.data(), result.data(), contrib.data(), bounds, cores); });
+    ok &= check("sequential fused", [&]() { sequential::page_rank_iter_fused(M, v.data(), result.data(), contrib.data(), dangling); });
+    sequential::Propagation_Blocking B(M, 1 << 12);
+    ok &= check("sequential blocked", [&]() { sequential::page_rank_iter_blocked(M, B, v.data(), result.data(), contrib.data(), dangling); });
+    ok &= check("parallel CSC fused", [&]() { parallel::page_rank_iter_fused(matrices, v.data(), result.data(), contrib.data(), next_contrib.data(), dangling, cores); });
+    ok &= check("parallel CSR fused", [&]() { parallel::page_rank_iter_fused(T, v.data(), result.data(), contrib.data(), next_contrib.data(), dangling, bounds, cores); });
+
+    ok &= check("parallel CSR simd", [&]() { parallel::page_rank_iter_simd(T, v.data(), result.data(), contrib.data(), next_contrib.data(), dangling, bounds, cores); });
+
+    // The whole solvers, after their first iteration
+    sequential::Page_Rank_Options seq_options;
+    seq_options.tolerance = 1e-10;
+    parallel::Page_Rank_Options par_options;
+    par_options.tolerance = 1e-10;
+
+    ok &= check_solve("sequential Page_Rank", [&](telemetry::Trace *trace) {
+        seq_options.trace = trace;
+        return sequential::Page_Rank(M, seq_options);
+    });
+    ok &= check_solve("sequential Page_Rank blocked", [&](telemetry::Trace *trace) {
+        sequential::Page_Rank_Options options = seq_options;
+        options.kernel = sequential::Kernel::PROPAGATION_BLOCKING;
+        options.trace = trace;
+        return sequential::Page_Rank(M, options);
+    });
+    ok &= check_solve("parallel Page_Rank CSC", [&](telemetry::Trace *trace) {
+        par_options.trace = trace;
+        return parallel::Page_Rank(matrices, cores, par_options);
+    });
+    ok &= check_solve("parallel Page_Rank_Persistent", [&](telemetry::Trace *trace) {
+        par_options.trace = trace;
+        return parallel::Page_Rank_Persistent(T, cores, par_options);
+    });
+
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
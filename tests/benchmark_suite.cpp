@@ -0,0 +1,422 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <map>
+#include <cstdlib>
+#include <cstdio>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <algorithm>
+
+#include "../src/seq_page_rank.cpp"
+#include "../src/par_page_rank.cpp"
+#include "../datagen/synthetic_graph.cpp"
+
+// Benchmarks the loading and the solve of the sequential and the parallel Page Rank, with warmups and repetitions,
+// over a sweep of thread counts, on the given graphs and on uniform and Kronecker random graphs, and writes the
+// percentiles of every measure as CSV or JSON. With a baseline written by a previous run, it also reports the measures whose median
+// has regressed.
+// g++ benchmark_suite.cpp -O3 -fopenmp -o benchmark_suite.exe
+
+
+// ------------------ Configuration ------------------
+
+/**
+ * @struct Config
+ * @brief The command line of the suite.
+ */
+struct Config {
+    std::vector<std::string> graphs;               // The graph files
+    std::vector<std::pair<long, long>> random;     // The nodes and the out degree of every uniform random graph
+    std::vector<std::pair<long, long>> kronecker;  // The scale and the edge factor of every Kronecker graph
+    std::vector<int> threads;                      // The thread counts of the parallel solver
+    int warmups = 2, runs = 10;
+    double tolerance = 1e-6;
+    std::string format = "csv";
+    const char *output = nullptr;                  // Defaults to the standard output
+    const char *baseline = nullptr;
+    double threshold = 0.1;                        // The relative slowdown of a median reported as a regression
+};
+
+
+void usage(const char *name) {
+    std::cout << "Usage: " << name << " [--graph <file>]... [--random <nodes>:<degree>]... [--kronecker <scale>:<edge_factor>]..." << std::endl
+              << "       [--threads <t1,t2,...>]" << std::endl
+              << "       [--warmups <w>] [--runs <r>] [--tolerance <tol>] [--format csv|json] [--output <file>]" << std::endl
+              << "       [--baseline <csv_file>] [--threshold <fraction>]" << std::endl;
+    exit(1);
+}
+
+
+/**
+ * @brief Parses the command line. The default thread counts are the powers of two up to the hardware threads, and
+ * the hardware threads themselves.
+ */
+Config parse_arguments(int argc, char *argv[]) {
+    Config config;
+
+    for (int i = 1; i < argc; i++) {
+        std::string flag = argv[i];
+        if (i + 1 >= argc) usage(argv[0]);
+        const char *value = argv[++i];
+
+        if (flag == "--graph") {
+            config.graphs.push_back(value);
+        } else if (flag == "--random") {
+            long nodes, degree;
+            if (std::sscanf(value, "%ld:%ld", &nodes, &degree) != 2 || nodes < 2 || degree < 1) usage(argv[0]);
+            config.random.push_back({nodes, degree});
+        } else if (flag == "--kronecker") {
+            long scale, edge_factor;
+            if (std::sscanf(value, "%ld:%ld", &scale, &edge_factor) != 2 || scale < 1 || scale > 40 || edge_factor < 1) usage(argv[0]);
+            config.kronecker.push_back({scale, edge_factor});
+        } else if (flag == "--threads") {
+            std::stringstream list(value);
+            std::string item;
+            while (std::getline(list, item, ',')) config.threads.push_back(atoi(item.c_str()));
+        } else if (flag == "--warmups") {
+            config.warmups = atoi(value);
+        } else if (flag == "--runs") {
+            config.runs = atoi(value);
+        } else if (flag == "--tolerance") {
+            config.tolerance = atof(value);
+        } else if (flag == "--format") {
+            config.format = value;
+        } else if (flag == "--output") {
+            config.output = value;
+        } else if (flag == "--baseline") {
+            config.baseline = value;
+        } else if (flag == "--threshold") {
+            config.threshold = atof(value);
+        } else {
+            usage(argv[0]);
+        }
+    }
+
+    if (config.graphs.empty() && config.random.empty() && config.kronecker.empty()) usage(argv[0]);
+    if (config.runs < 1 || config.warmups < 0 || (config.format != "csv" && config.format != "json")) usage(argv[0]);
+
+    if (config.threads.empty()) {
+        int hardware = std::max(1u, std::thread::hardware_concurrency());
+        for (int t = 1; t < hardware; t *= 2) config.threads.push_back(t);
+        config.threads.push_back(hardware);
+    }
+    for (int t : config.threads) {
+        if (t < 1) usage(argv[0]);
+    }
+
+    return config;
+}
+
+
+// ------------------ Statistics ------------------
+
+/**
+ * @struct Summary
+ * @brief The distribution of the samples of a measure, in seconds.
+ */
+struct Summary {
+    int runs;
+    double min, p25, median, p75, p95, max, mean, stddev;
+};
+
+
+/**
+ * @brief Returns the percentile p (in [0, 1]) of sorted samples, interpolating linearly between the closest ranks.
+ */
+double percentile(const std::vector<double> &sorted, double p) {
+    double position = p * (sorted.size() - 1);
+    size_t below = (size_t)position;
+    if (below + 1 >= sorted.size()) return sorted.back();
+    return sorted[below] + (position - below) * (sorted[below + 1] - sorted[below]);
+}
+
+
+Summary summarize(std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+
+    Summary s;
+    s.runs = samples.size();
+    s.min = samples.front();
+    s.p25 = percentile(samples, 0.25);
+    s.median = percentile(samples, 0.5);
+    s.p75 = percentile(samples, 0.75);
+    s.p95 = percentile(samples, 0.95);
+    s.max = samples.back();
+
+    s.mean = 0;
+    for (double x : samples) s.mean += x / samples.size();
+    double variance = 0;
+    for (double x : samples) variance += (x - s.mean) * (x - s.mean);
+    s.stddev = samples.size() > 1 ? sqrt(variance / (samples.size() - 1)) : 0;
+
+    return s;
+}
+
+
+/**
+ * @brief Runs the function warmups + runs times and returns the seconds of every run after the warmups.
+ */
+template <typename Function>
+std::vector<double> measure(int warmups, int runs, Function f) {
+    std::vector<double> samples;
+    for (int i = 0; i < warmups + runs; i++) {
+        telemetry::Clock::time_point start = telemetry::Clock::now();
+        f();
+        double elapsed = telemetry::seconds(start, telemetry::Clock::now());
+        if (i >= warmups) samples.push_back(elapsed);
+    }
+    return samples;
+}
+
+
+// ------------------ Results ------------------
+
+/**
+ * @struct Result
+ * @brief A line of the output: the distribution of one measure of one solver on one graph.
+ */
+struct Result {
+    std::string graph;
+    long n, NNZ;
+    std::string solver;
+    int threads;
+    std::string metric;   // load_seconds, solve_seconds or iteration_seconds, the wall times of the traced iterations
+    int iterations;
+    Summary summary;
+};
+
+
+/**
+ * @brief Returns the key that identifies a measure across runs of the suite.
+ */
+std::string key(const std::string &graph, const std::string &solver, int threads, const std::string &metric) {
+    return graph + "," + solver + "," + std::to_string(threads) + "," + metric;
+}
+
+
+void write_csv(std::ostream &out, const std::vector<Result> &results) {
+    out << "graph,n,nnz,solver,threads,metric,iterations,runs,min,p25,median,p75,p95,max,mean,stddev" << std::endl;
+    for (const Result &r : results) {
+        const Summary &s = r.summary;
+        out << r.graph << "," << r.n << "," << r.NNZ << "," << r.solver << "," << r.threads << "," << r.metric << ","
+            << r.iterations << "," << s.runs << "," << s.min << "," << s.p25 << "," << s.median << "," << s.p75 << ","
+            << s.p95 << "," << s.max << "," << s.mean << "," << s.stddev << std::endl;
+    }
+}
+
+
+void write_json(std::ostream &out, const std::vector<Result> &results) {
+    out << "[";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result &r = results[i];
+        const Summary &s = r.summary;
+        out << (i == 0 ? "\n  {" : ",\n  {") << "\"graph\": \"" << r.graph << "\", \"n\": " << r.n << ", \"nnz\": " << r.NNZ
+            << ", \"solver\": \"" << r.solver << "\", \"threads\": " << r.threads << ", \"metric\": \"" << r.metric
+            << "\", \"iterations\": " << r.iterations << ", \"runs\": " << s.runs << ", \"min\": " << s.min
+            << ", \"p25\": " << s.p25 << ", \"median\": " << s.median << ", \"p75\": " << s.p75 << ", \"p95\": " << s.p95
+            << ", \"max\": " << s.max << ", \"mean\": " << s.mean << ", \"stddev\": " << s.stddev << "}";
+    }
+    out << "\n]" << std::endl;
+}
+
+
+/**
+ * @brief Reads the medians of a CSV written by the suite, by key.
+ */
+std::map<std::string, double> read_baseline(const char *filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cout << "Unable to open file" << std::endl;
+        exit(1);
+    }
+
+    std::map<std::string, double> medians;
+    std::string line;
+    std::getline(file, line);
+    while (std::getline(file, line)) {
+        std::vector<std::string> fields;
+        std::stringstream row(line);
+        std::string field;
+        while (std::getline(row, field, ',')) fields.push_back(field);
+        if (fields.size() != 16) continue;
+
+        medians[key(fields[0], fields[3], atoi(fields[4].c_str()), fields[5])] = atof(fields[10].c_str());
+    }
+
+    return medians;
+}
+
+
+// ------------------ Benchmarks ------------------
+
+/**
+ * @brief Silences the standard output while it is alive, so the messages of the loaders do not mix with the results.
+ */
+struct Quiet {
+    std::ostringstream sink;
+    std::streambuf *saved;
+
+    Quiet() : saved(std::cout.rdbuf(sink.rdbuf())) {}
+    ~Quiet() { std::cout.rdbuf(saved); }
+};
+
+
+/**
+ * @brief Appends the wall time of every iteration of a traced solve to the samples, unless the solve is a warmup.
+ */
+void add_iterations(const telemetry::Page_Rank_Result &r, int &run, int warmups, std::vector<double> &samples) {
+    if (run++ < warmups) return;
+    for (const telemetry::Iteration_Stats &s : r.trace.iterations) samples.push_back(s.seconds);
+}
+
+
+/**
+ * @brief Benchmarks the sequential power method, then the parallel power method at every thread count, on a graph.
+ */
+void benchmark_graph(const Config &config, const char *filename, const std::string &name, std::vector<Result> &results) {
+    sequential::CSC_Matrix *M = nullptr;
+    std::vector<double> load = measure(config.warmups, config.runs, [&]() {
+        Quiet quiet;
+        delete M;
+        M = sequential::load_graph_CSC(filename);
+    });
+
+    const long n = M->n, NNZ = M->NNZ;
+    std::vector<double> *initial = sequential::gen_random_vector(n, 42);
+    std::cerr << name << ": " << n << " nodes, " << NNZ << " edges" << std::endl;
+
+    auto add = [&](const std::string &solver, int threads, const std::string &metric, int iterations, const std::vector<double> &samples) {
+        results.push_back({name, n, NNZ, solver, threads, metric, iterations, summarize(samples)});
+    };
+
+    // Sequential
+    sequential::Page_Rank_Options seq_options;
+    seq_options.initial = initial;
+    seq_options.tolerance = config.tolerance;
+    int iterations = 0, run = 0;
+    std::vector<double> per_iteration;
+
+    std::vector<double> solve = measure(config.warmups, config.runs, [&]() {
+        telemetry::Page_Rank_Result r = sequential::Page_Rank_Traced(M, seq_options);
+        iterations = r.iterations;
+        add_iterations(r, run, config.warmups, per_iteration);
+    });
+
+    add("sequential", 1, "load_seconds", 0, load);
+    add("sequential", 1, "solve_seconds", iterations, solve);
+    add("sequential", 1, "iteration_seconds", iterations, per_iteration);
+    delete M;
+
+    // Parallel, at every thread count
+    for (int cores : config.threads) {
+        parallel::CSR_Matrix *T = nullptr;
+        load = measure(config.warmups, config.runs, [&]() {
+            Quiet quiet;
+            delete T;
+            T = parallel::load_graph_CSR(filename, cores);
+        });
+
+        parallel::Page_Rank_Options par_options;
+        par_options.initial = initial;
+        par_options.tolerance = config.tolerance;
+        run = 0;
+        per_iteration.clear();
+
+        solve = measure(config.warmups, config.runs, [&]() {
+            telemetry::Page_Rank_Result r = parallel::Page_Rank_Traced(T, cores, par_options);
+            iterations = r.iterations;
+            add_iterations(r, run, config.warmups, per_iteration);
+        });
+
+        add("parallel", cores, "load_seconds", 0, load);
+        add("parallel", cores, "solve_seconds", iterations, solve);
+        add("parallel", cores, "iteration_seconds", iterations, per_iteration);
+        delete T;
+    }
+
+    delete initial;
+}
+
+
+/**
+ * @brief Generates a random graph into a temporary edge list and benchmarks it.
+ */
+void benchmark_synthetic(const Config &config, synthetic::Generator_Options options, const std::string &name,
+                         std::vector<Result> &results) {
+    options.seed = 42;
+    options.threads = *std::max_element(config.threads.begin(), config.threads.end());
+    synthetic::Generator G(options);
+
+    std::string filename = name + ".txt";
+    synthetic::write_text(G, filename.c_str());
+    benchmark_graph(config, filename.c_str(), name, results);
+    std::remove(filename.c_str());
+}
+
+
+int main(int argc, char *argv[]) {
+    Config config = parse_arguments(argc, argv);
+    std::vector<Result> results;
+
+    // The progress goes to the standard error, the results to the output
+    for (const std::string &filename : config.graphs) {
+        std::string name = filename.substr(filename.find_last_of("/\\") + 1);
+        benchmark_graph(config, filename.c_str(), name, results);
+    }
+
+    for (const std::pair<long, long> &g : config.random) {
+        synthetic::Generator_Options options;
+        options.model = synthetic::Model::UNIFORM;
+        options.nodes = g.first;
+        options.edge_factor = g.second;
+        benchmark_synthetic(config, options, "uniform-" + std::to_string(g.first) + "-" + std::to_string(g.second), results);
+    }
+
+    for (const std::pair<long, long> &g : config.kronecker) {
+        synthetic::Generator_Options options;
+        options.model = synthetic::Model::KRONECKER;
+        options.scale = g.first;
+        options.edge_factor = g.second;
+        benchmark_synthetic(config, options, "kronecker-" + std::to_string(g.first) + "-" + std::to_string(g.second), results);
+    }
+
+    std::ofstream file;
+    if (config.output != nullptr) {
+        file.open(config.output);
+        if (!file.is_open()) {
+            std::cout << "Unable to open file" << std::endl;
+            return 1;
+        }
+    }
+    std::ostream &out = config.output != nullptr ? file : std::cout;
+    out.precision(9);
+
+    if (config.format == "json") {
+        write_json(out, results);
+    } else {
+        write_csv(out, results);
+    }
+
+    if (config.baseline == nullptr) return 0;
+
+    // Only the solve and the iterations are compared: the loading depends too much on the page cache
+    std::map<std::string, double> baseline = read_baseline(config.baseline);
+    int regressions = 0;
+    for (const Result &r : results) {
+        if (r.metric == "load_seconds") continue;
+
+        auto it = baseline.find(key(r.graph, r.solver, r.threads, r.metric));
+        if (it == baseline.end() || r.summary.median <= it->second * (1 + config.threshold)) continue;
+
+        std::cerr << "REGRESSION: " << r.graph << " " << r.solver << " " << r.threads << " threads " << r.metric << ": median "
+                  << r.summary.median << " s, baseline " << it->second << " s" << std::endl;
+        regressions++;
+    }
+
+    std::cerr << regressions << " regressions against " << config.baseline << std::endl;
+    return regressions == 0 ? 0 : 2;
+}
@@ -0,0 +1,102 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+#include "../src/seq_page_rank.cpp"
+
+// Compares the throughput of the scatter and of the propagation blocking kernels on random graphs of growing size.
+// g++ blocking_benchmark.cpp -O3 -o blocking_benchmark.exe
+
+
+/**
+ * @brief Builds a random graph where every node has the same out degree and uniformly random destinations.
+ */
+sequential::CSC_Matrix* random_graph(long n, long degree) {
+    sequential::CSC_Matrix *M = new sequential::CSC_Matrix(n, n * degree);
+    std::mt19937_64 generator(n);
+    std::uniform_int_distribution<long> node(0, n - 1);
+
+    for (long i = 0; i < n; i++) {
+        M->COL_PTR[i] = i * degree;
+        M->OUT_DEGREE[i] = degree;
+        for (long j = i * degree; j < (i + 1) * degree; j++) {
+            M->ROW_INDEX[j] = node(generator);
+        }
+    }
+    M->COL_PTR[n] = n * degree;
+
+    return M;
+}
+
+
+/**
+ * @brief Runs the given iteration and returns the throughput in edges per second.
+ */
+template <typename Iteration>
+double throughput(long NNZ, int iterations, Iteration iteration) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        iteration();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double> elapsed = end - start;
+    return NNZ * iterations / elapsed.count();
+}
+
+
+int main(int argc, char *argv[]) {
+    if (argc < 2 || argc > 4) {
+        std::cout << "Usage: " << argv[0] << " <max_nodes> [degree] [bin_rows]" << std::endl;
+        return 1;
+    }
+
+    const long max_nodes = atol(argv[1]);
+    const long degree = argc >= 3 ? atol(argv[2]) : 8;
+    const long bin_rows = argc == 4 ? atol(argv[3]) : sequential::Page_Rank_Options().bin_rows;
+    const int iterations = 10;
+
+    for (long n = 100000; n <= max_nodes; n *= 10) {
+        sequential::CSC_Matrix *M = random_graph(n, degree);
+        sequential::Propagation_Blocking B(M, bin_rows);
+
+        std::vector<double> v(n), result(n, 0), contrib(n), blocked_result(n);
+        double dangling;
+
+        auto reset = [&]() {
+            std::fill(v.begin(), v.end(), 1.0 / n);
+            std::fill(result.begin(), result.end(), 0);
+            dangling = sequential::prepare_contrib(M, v.data(), contrib.data());
+        };
+
+        reset();
+        double scatter = throughput(M->NNZ, iterations, [&]() {
+            sequential::page_rank_iter_fused(M, v.data(), result.data(), contrib.data(), dangling);
+            std::swap(v, result);
+        });
+        std::vector<double> scatter_ranks = v;
+
+        reset();
+        double blocked = throughput(M->NNZ, iterations, [&]() {
+            sequential::page_rank_iter_blocked(M, B, v.data(), result.data(), contrib.data(), dangling);
+            std::swap(v, result);
+        });
+
+        double max_diff = 0;
+        for (long i = 0; i < n; i++) {
+            max_diff = std::max(max_diff, std::abs(v[i] - scatter_ranks[i]));
+        }
+
+        std::cout << "Nodes: " << n << ", edges: " << M->NNZ << ", bins: " << B.num_bins << std::endl;
+        std::cout << "  scatter:              " << scatter / 1e6 << " M edges/s" << std::endl;
+        std::cout << "  propagation blocking: " << blocked / 1e6 << " M edges/s" << std::endl;
+        std::cout << "  max difference: " << max_diff << std::endl;
+
+        delete M;
+    }
+
+    return 0;
+}
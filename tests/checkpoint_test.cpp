@@ -0,0 +1,100 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../src/seq_page_rank.cpp"
+
+// Checks the warm start and the checkpoints: a solve killed while running resumes from its last checkpoint.
+// g++ checkpoint_test.cpp -O3 -o checkpoint_test.exe
+
+
+/**
+ * @brief Returns the L1 distance between two vectors.
+ */
+double distance(const std::vector<double> &a, const std::vector<double> &b) {
+    double d = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        d += std::abs(a[i] - b[i]);
+    }
+    return d;
+}
+
+
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        std::cout << "Usage: " << argv[0] << " <graph_file> <checkpoint_file>" << std::endl;
+        return 1;
+    }
+
+    const char *filename = argv[1];
+    const char *checkpoint_file = argv[2];
+    std::remove(checkpoint_file);
+
+    sequential::CSC_Matrix *M = sequential::load_graph_CSC(filename);
+    std::cout << std::endl;
+    bool ok = true;
+
+    // Reference and cold start
+    int cold_iterations;
+    sequential::Page_Rank_Options options;
+    options.tolerance = 1e-10;
+    options.iterations = &cold_iterations;
+    std::vector<double> *reference = sequential::Page_Rank(M, options);
+
+    // Warm start from a rough solution saved to disk
+    sequential::Page_Rank_Options rough;
+    rough.tolerance = 1e-4;
+    std::vector<double> *previous = sequential::Page_Rank(M, rough);
+    rank_file::save(checkpoint_file, *previous);
+    std::vector<double> *initial = rank_file::load(checkpoint_file, nullptr, M->n);
+    std::remove(checkpoint_file);
+
+    int warm_iterations;
+    options.initial = initial;
+    options.iterations = &warm_iterations;
+    std::vector<double> *warm = sequential::Page_Rank(M, options);
+    options.initial = nullptr;
+
+    std::cout << "Cold start: " << cold_iterations << " iterations" << std::endl;
+    std::cout << "Warm start: " << warm_iterations << " iterations, L1 distance " << distance(*warm, *reference) << std::endl;
+    ok &= warm_iterations < cold_iterations && distance(*warm, *reference) < 1e-8;
+
+    // Kill a solve that never converges once it has written a checkpoint, then resume it
+    pid_t child = fork();
+    if (child == 0) {
+        sequential::Page_Rank_Options endless;
+        endless.tolerance = 0;
+        endless.checkpoint_file = checkpoint_file;
+        endless.checkpoint_interval = 3;
+        sequential::Page_Rank(M, endless);
+        _exit(0);
+    }
+
+    while (!rank_file::exists(checkpoint_file)) {
+        usleep(1000);
+    }
+    usleep(20000);
+    kill(child, SIGKILL);
+    waitpid(child, nullptr, 0);
+
+    int saved_iterations;
+    delete rank_file::load(checkpoint_file, &saved_iterations, M->n);
+
+    int resumed_iterations;
+    options.checkpoint_file = checkpoint_file;
+    options.iterations = &resumed_iterations;
+    std::vector<double> *resumed = sequential::Page_Rank(M, options);
+
+    std::cout << "Killed after " << saved_iterations << " checkpointed iterations, resumed until " << resumed_iterations
+              << ", L1 distance " << distance(*resumed, *reference) << std::endl;
+    ok &= saved_iterations > 0 && resumed_iterations > saved_iterations && distance(*resumed, *reference) < 1e-8;
+    ok &= !rank_file::exists(checkpoint_file);
+
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
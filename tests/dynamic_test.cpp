@@ -0,0 +1,89 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <chrono>
+#include <cmath>
+
+#include "../src/seq_dynamic_page_rank.cpp"
+
+// Applies batches of random edge changes and compares the incremental update with a full solve of the new graph. The
+// error of every batch must stay within the bound given by the residual threshold, and within the bound given by the
+// residual actually carried in the workspace.
+// g++ dynamic_test.cpp -O3 -fopenmp -o dynamic_test.exe
+
+
+int main(int argc, char *argv[]) {
+    if (argc != 4 && argc != 5) {
+        std::cout << "Usage: " << argv[0] << " <graph_file> <num_batches> <batch_size> [epsilon]" << std::endl;
+        return 1;
+    }
+
+    const char *filename = argv[1];
+    const int batches = atoi(argv[2]);
+    const int batch_size = atoi(argv[3]);
+    const double epsilon = argc == 5 ? atof(argv[4]) : 1e-9;
+
+    edge_list::Parse_Options parse_options;
+    parse_options.remove_duplicates = true;
+    sequential::Dynamic_CSC_Matrix G(sequential::load_graph_CSC(filename, 1, parse_options));
+    sequential::Local_Push_Workspace W(G.n);
+
+    sequential::Page_Rank_Options options;
+    options.tolerance = 1e-12;
+    std::vector<double> *x = sequential::Page_Rank(G.base, options);
+
+    // Every residual left is below epsilon times the out degree of its node (1 for a dangling node), and the error
+    // is at most the L1 norm of the residual divided by 1 - 0.85
+    const double bound = epsilon * (G.NNZ + G.n) / 0.15;
+    bool ok = true;
+
+    srand(42);
+    for (int b = 0; b < batches; b++) {
+        // Half of the changes delete existing edges, half insert random ones
+        std::vector<std::pair<long, long>> insertions, deletions;
+        while ((int)deletions.size() < batch_size / 2) {
+            long u = rand() % G.n;
+            if (G.OUT_DEGREE[u] == 0) continue;
+
+            long pick = rand() % G.OUT_DEGREE[u], i = 0;
+            G.for_each_out_edge(u, [&](long v) { if (i++ == pick) deletions.emplace_back(u, v); });
+        }
+        while ((int)insertions.size() < batch_size - batch_size / 2) {
+            insertions.emplace_back(rand() % G.n, rand() % G.n);
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        long pushes = sequential::Page_Rank_Update(G, *x, insertions, deletions, W, epsilon);
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> incremental = end - start;
+
+        start = std::chrono::high_resolution_clock::now();
+        std::vector<double> *exact = sequential::Page_Rank(G.matrix(), options);
+        end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> full = end - start;
+
+        double sum = 0, distance = 0;
+        for (long i = 0; i < G.n; i++) {
+            distance += std::abs((*x)[i] - (*exact)[i]);
+            sum += (*x)[i];
+        }
+        delete exact;
+
+        // The residual left below epsilon grows with the batches, and the error with it, up to the bound
+        double residual = 0;
+        for (long u : W.touched) residual += std::abs(W.residual[u]);
+
+        std::cout << "Batch " << b << ": " << pushes << " pushes, incremental " << incremental.count() << " s, full "
+                  << full.count() << " s, L1 distance " << distance << ", carried residual " << residual << ", sum "
+                  << sum << std::endl;
+
+        // The full solve stops at a tolerance of 1e-12, which leaves it an error of its own
+        ok &= distance <= bound && distance <= residual / 0.15 + 1e-10 && std::abs(sum - 1) < 1e-9;
+    }
+
+    std::cout << "Error bound " << bound << std::endl;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+
+    delete x;
+    return ok ? 0 : 1;
+}
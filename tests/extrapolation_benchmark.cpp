@@ -0,0 +1,134 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+#include "../src/seq_page_rank.cpp"
+
+// Compares the iterations and the time of the power method with and without the Aitken and quadratic
+// extrapolations, on the given graph and on random graphs of almost closed communities with dangling nodes.
+// g++ extrapolation_benchmark.cpp -O3 -o extrapolation_benchmark.exe
+
+
+/**
+ * @brief Builds a random graph of communities of 100 nodes, where a tenth of the nodes are dangling, the others have
+ * the given out degree, and 1% of the edges leave the community of their source, with destinations skewed towards
+ * the first nodes.
+ *
+ * As in web graphs, the communities are almost closed, so the second eigenvalue of the Google matrix is close to the
+ * damping factor and the power method converges slowly.
+ */
+sequential::CSC_Matrix* community_graph(long n, long degree) {
+    std::mt19937_64 generator(n);
+    std::uniform_real_distribution<double> uniform(0, 1);
+
+    long linked = n - n / 10;
+    sequential::CSC_Matrix *M = new sequential::CSC_Matrix(n, linked * degree);
+
+    long k = 0;
+    for (long i = 0; i < n; i++) {
+        M->COL_PTR[i] = k;
+        if (i % 10 == 9) {
+            M->OUT_DEGREE[i] = 0;
+            M->indexes_null_cols.push_back(i);
+            continue;
+        }
+
+        M->OUT_DEGREE[i] = degree;
+        for (long j = 0; j < degree; j++) {
+            double u = uniform(generator);
+            if (uniform(generator) < 0.01) {
+                M->ROW_INDEX[k++] = std::min<long>(n - 1, n * u * u * u);
+            } else {
+                M->ROW_INDEX[k++] = std::min<long>(n - 1, i / 100 * 100 + (long)(100 * u));
+            }
+        }
+    }
+    M->COL_PTR[n] = k;
+    M->NNZ = k;
+    M->num_null_cols = M->indexes_null_cols.size();
+
+    return M;
+}
+
+
+/**
+ * @brief Solves the graph with every extrapolation and prints the iterations, the time and the error of each.
+ */
+template <typename Matrix>
+void compare(const std::string &name, Matrix *M, double tolerance, int interval) {
+    std::vector<double> *initial = sequential::gen_random_vector(M->n, 42);
+
+    sequential::Page_Rank_Options options;
+    options.initial = initial;
+    options.tolerance = 1e-14;
+    std::vector<double> *reference = sequential::Page_Rank(M, options);
+
+    options.tolerance = tolerance;
+    options.extrapolation_interval = interval;
+    int iterations;
+    options.iterations = &iterations;
+
+    int plain_iterations = 0;
+    double plain_time = 0;
+
+    for (sequential::Extrapolation method : {sequential::Extrapolation::NONE, sequential::Extrapolation::AITKEN,
+                                             sequential::Extrapolation::QUADRATIC}) {
+        options.extrapolation = method;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        std::vector<double> *ranks = sequential::Page_Rank(M, options);
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> elapsed = end - start;
+
+        double error = 0;
+        for (long i = 0; i < M->n; i++) {
+            error += std::abs((*ranks)[i] - (*reference)[i]);
+        }
+
+        if (method == sequential::Extrapolation::NONE) {
+            plain_iterations = iterations;
+            plain_time = elapsed.count();
+        }
+
+        const char *method_name = method == sequential::Extrapolation::NONE ? "power"
+                                : method == sequential::Extrapolation::AITKEN ? "aitken" : "quadratic";
+        std::cout << name << "," << M->n << "," << method_name << "," << iterations << "," << elapsed.count() * 1e3 << ","
+                  << plain_iterations - iterations << "," << (plain_time - elapsed.count()) * 1e3 << "," << error << std::endl;
+
+        delete ranks;
+    }
+
+    delete reference;
+    delete initial;
+}
+
+
+int main(int argc, char *argv[]) {
+    if (argc < 2 || argc > 5) {
+        std::cout << "Usage: " << argv[0] << " <graph_file> [max_synthetic_nodes] [tolerance] [interval]" << std::endl;
+        return 1;
+    }
+
+    const char *filename = argv[1];
+    const long max_nodes = argc >= 3 ? atol(argv[2]) : 1000000;
+    const double tolerance = argc >= 4 ? atof(argv[3]) : 1e-10;
+    const int interval = argc == 5 ? atoi(argv[4]) : 10;
+
+    sequential::CSC_Matrix *M = sequential::load_graph_CSC(filename);
+    std::cout << std::endl;
+
+    std::cout << "graph,n,method,iterations,time_ms,iterations_saved,time_saved_ms,L1_error" << std::endl;
+    compare(filename, M, tolerance, interval);
+    delete M;
+
+    for (long n = 100000; n <= max_nodes; n *= 10) {
+        M = community_graph(n, 8);
+        compare("synthetic", M, tolerance, interval);
+        delete M;
+    }
+
+    return 0;
+}
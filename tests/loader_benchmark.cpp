@@ -0,0 +1,160 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdio>
+
+#include "../datagen/seq_csc_matrix.cpp"
+
+// Compares the ifstream loader with the memory-mapped parallel parser, in edges per second, on sorted and shuffled edge lists.
+// g++ loader_benchmark.cpp -O3 -fopenmp -o loader_benchmark.exe
+
+
+/**
+ * @brief Writes a random edge list in the same format as the SNAP files.
+ * 
+ * @param filename The name of the output file.
+ * @param n The number of nodes.
+ * @param NNZ The number of edges.
+ * @param shuffled Whether to write the edges in random order instead of sorted by FromNodeId.
+ */
+void write_synthetic_graph(const char *filename, long n, long NNZ, bool shuffled) {
+    std::ofstream file(filename);
+    std::mt19937_64 gen(42);
+    std::uniform_int_distribution<long> node(0, n - 1);
+
+    // Spread the edges evenly over the sources so the list is sorted by construction
+    std::vector<std::pair<long, long>> edges(NNZ);
+    for (long e = 0; e < NNZ; e++) {
+        edges[e] = std::make_pair(e * n / NNZ, node(gen));
+    }
+    if (shuffled) {
+        std::shuffle(edges.begin(), edges.end(), gen);
+    }
+
+    file << "# Directed graph: synthetic" << std::endl;
+    file << "# Uniform random edges" << (shuffled ? ", shuffled" : "") << std::endl;
+    file << "# Nodes: " << n << " Edges: " << NNZ << std::endl;
+    file << "# FromNodeId\tToNodeId" << std::endl;
+
+    for (auto &e : edges) {
+        file << e.first << "\t" << e.second << "\n";
+    }
+}
+
+
+/**
+ * @brief Runs every loader on the given file and checks that they build the same matrix.
+ */
+void benchmark(const char *filename, int threads) {
+    std::cout << "----- " << filename << " -----" << std::endl;
+
+    std::streambuf *out = std::cout.rdbuf(nullptr); // silence the loaders
+    auto start = std::chrono::high_resolution_clock::now();
+    sequential::CSC_Matrix *ref = sequential::load_graph_CSC_stream(filename);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout.rdbuf(out);
+
+    long NNZ = ref->NNZ;
+    std::chrono::duration<double> elapsed = end - start;
+    std::cout << "ifstream + stoi: " << elapsed.count() << " s, " << NNZ / elapsed.count() / 1e6 << " M edges/s" << std::endl;
+
+    for (int t : {1, threads}) {
+        std::string name = "mmap + from_chars (" + std::to_string(t) + " threads)";
+        std::cout.rdbuf(nullptr);
+        start = std::chrono::high_resolution_clock::now();
+        sequential::CSC_Matrix *M = sequential::load_graph_CSC(filename, t);
+        end = std::chrono::high_resolution_clock::now();
+        std::cout.rdbuf(out);
+        elapsed = end - start;
+        std::cout << name << ": " << elapsed.count() << " s, " << NNZ / elapsed.count() / 1e6 << " M edges/s" << std::endl;
+
+        if (M->COL_PTR != ref->COL_PTR || M->ROW_INDEX != ref->ROW_INDEX || M->OUT_DEGREE != ref->OUT_DEGREE
+            || M->indexes_null_cols != ref->indexes_null_cols) {
+            std::cout << "Mismatch with the ifstream loader" << std::endl;
+            exit(1);
+        }
+        delete M;
+    }
+
+    delete ref;
+    std::cout << std::endl;
+}
+
+
+/**
+ * @brief Loads a shuffled edge list and checks it against the sorted list with the same edges.
+ */
+void benchmark_unsorted(const char *sorted_file, const char *shuffled_file, int threads) {
+    std::cout << "----- " << shuffled_file << " -----" << std::endl;
+
+    edge_list::Parse_Options options;
+    options.sort_columns = true;
+
+    std::streambuf *out = std::cout.rdbuf(nullptr); // silence the loaders
+    sequential::CSC_Matrix *ref = sequential::load_graph_CSC(sorted_file, threads, options);
+    std::cout.rdbuf(out);
+    long NNZ = ref->NNZ;
+
+    for (int t : {1, threads}) {
+        for (bool sort : {false, true}) {
+            std::string name = std::string("unsorted") + (sort ? " + column sort" : "") + " (" + std::to_string(t) + " threads)";
+            options.sort_columns = sort;
+
+            std::cout.rdbuf(nullptr);
+            auto start = std::chrono::high_resolution_clock::now();
+            sequential::CSC_Matrix *M = sequential::load_graph_CSC(shuffled_file, t, options);
+            auto end = std::chrono::high_resolution_clock::now();
+            std::cout.rdbuf(out);
+            std::chrono::duration<double> elapsed = end - start;
+            std::cout << name << ": " << elapsed.count() << " s, " << NNZ / elapsed.count() / 1e6 << " M edges/s" << std::endl;
+
+            if (M->COL_PTR != ref->COL_PTR || M->OUT_DEGREE != ref->OUT_DEGREE || (sort && M->ROW_INDEX != ref->ROW_INDEX)) {
+                std::cout << "Mismatch with the sorted edge list" << std::endl;
+                exit(1);
+            }
+            delete M;
+        }
+    }
+
+    options.remove_duplicates = true;
+    std::cout.rdbuf(nullptr);
+    sequential::CSC_Matrix *M = sequential::load_graph_CSC(shuffled_file, threads, options);
+    std::cout.rdbuf(out);
+    std::cout << "Distinct edges: " << M->NNZ << " of " << NNZ << std::endl;
+
+    delete M;
+    delete ref;
+    std::cout << std::endl;
+}
+
+
+int main(int argc, char *argv[]) {
+    if (argc != 3 && argc != 4) {
+        std::cout << "Usage: " << argv[0] << " <graph_file> <num_threads> [synthetic_edges]" << std::endl;
+        return 1;
+    }
+
+    const char *filename = argv[1];
+    const int threads = atoi(argv[2]);
+    const long synthetic_edges = argc == 4 ? atol(argv[3]) : 20000000;
+
+    benchmark(filename, threads);
+
+    const char *synthetic = "loader_benchmark_synthetic.txt";
+    const char *shuffled = "loader_benchmark_shuffled.txt";
+    write_synthetic_graph(synthetic, synthetic_edges / 8, synthetic_edges, false);
+    write_synthetic_graph(shuffled, synthetic_edges / 8, synthetic_edges, true);
+
+    benchmark(synthetic, threads);
+    benchmark_unsorted(synthetic, shuffled, threads);
+
+    std::remove(synthetic);
+    std::remove(shuffled);
+
+    return 0;
+}
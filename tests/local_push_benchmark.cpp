@@ -0,0 +1,63 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <chrono>
+#include <cmath>
+
+#include "../src/seq_personalized_page_rank.cpp"
+#include "../src/par_personalized_page_rank.cpp"
+
+// Compares the forward push with the full personalized Page Rank on random single-node seeds.
+// g++ local_push_benchmark.cpp -O3 -fopenmp -o local_push_benchmark.exe
+
+
+int main(int argc, char *argv[]) {
+    if (argc != 3 && argc != 4) {
+        std::cout << "Usage: " << argv[0] << " <graph_file> <num_seeds> [epsilon]" << std::endl;
+        return 1;
+    }
+
+    const char *filename = argv[1];
+    const int k = atoi(argv[2]);
+    const double epsilon = argc == 4 ? atof(argv[3]) : 1e-7;
+
+    sequential::CSC_Matrix *M = sequential::load_graph_CSC(filename);
+    parallel::CSR_Matrix *T = parallel::load_graph_CSR(filename, 1);
+    sequential::Local_Push_Workspace W(M->n);
+
+    srand(42);
+    double push_time = 0, full_time = 0, max_error = 0, total_nonzeros = 0;
+
+    for (int q = 0; q < k; q++) {
+        long seed = rand() % M->n;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        const std::vector<std::pair<long, double>> *local = sequential::Local_Page_Rank(M, seed, epsilon, W);
+        auto end = std::chrono::high_resolution_clock::now();
+        push_time += std::chrono::duration<double>(end - start).count();
+        total_nonzeros += local->size();
+
+        parallel::Page_Rank_Options options;
+        options.tolerance = 1e-12;
+
+        start = std::chrono::high_resolution_clock::now();
+        std::vector<std::vector<double>> *full = parallel::Personalized_Page_Rank_Batch(T, {parallel::teleport_from_seeds(M->n, {seed})}, 1, {}, options);
+        end = std::chrono::high_resolution_clock::now();
+        full_time += std::chrono::duration<double>(end - start).count();
+
+        std::vector<double> &exact = (*full)[0];
+        for (auto &entry : *local) {
+            exact[entry.first] -= entry.second;
+        }
+        for (double d : exact) {
+            max_error = std::max(max_error, std::abs(d));
+        }
+        delete full;
+    }
+
+    std::cout << "Forward push: " << push_time / k * 1e3 << " ms per seed, " << total_nonzeros / k << " non-zero ranks on average" << std::endl;
+    std::cout << "Full personalized Page Rank: " << full_time / k * 1e3 << " ms per seed" << std::endl;
+    std::cout << "Max error: " << max_error << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,112 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <random>
+
+#include "../src/mpi_page_rank.cpp"
+
+// Times the distributed Page Rank on the processes of mpirun and the shared-memory parallel::Page_Rank with the same
+// total number of threads. Strong scaling uses a given graph; weak scaling generates a random graph whose size grows
+// with the number of processes.
+// mpicxx mpi_scaling_benchmark.cpp -O3 -fopenmp -o mpi_scaling_benchmark.exe
+// mpirun -np <processes> mpi_scaling_benchmark.exe strong <graph_file> <threads_per_process>
+// mpirun -np <processes> mpi_scaling_benchmark.exe weak <nodes_per_process> <degree> <threads_per_process>
+
+
+/**
+ * @brief Writes a random graph where every node has the same out degree and uniformly random destinations.
+ */
+void write_random_graph(const std::string &filename, long n, long degree) {
+    std::ofstream file(filename);
+    std::mt19937_64 generator(n);
+    std::uniform_int_distribution<long> node(0, n - 1);
+
+    file << "# Nodes: " << n << " Edges: " << n * degree << "\n";
+    for (long i = 0; i < n; i++) {
+        for (long j = 0; j < degree; j++) {
+            file << i << "\t" << node(generator) << "\n";
+        }
+    }
+}
+
+
+int main(int argc, char *argv[]) {
+    MPI_Init(&argc, &argv);
+
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    bool strong = argc == 4 && strcmp(argv[1], "strong") == 0;
+    bool weak = argc == 5 && strcmp(argv[1], "weak") == 0;
+    if (!strong && !weak) {
+        if (rank == 0) {
+            std::cout << "Usage: " << argv[0] << " strong <graph_file> <threads_per_process>" << std::endl;
+            std::cout << "       " << argv[0] << " weak <nodes_per_process> <degree> <threads_per_process>" << std::endl;
+        }
+        MPI_Finalize();
+        return 1;
+    }
+
+    std::string filename;
+    int cores;
+    if (strong) {
+        filename = argv[2];
+        cores = atoi(argv[3]);
+    } else {
+        filename = "mpi_weak_scaling_" + std::to_string(size) + ".txt";
+        cores = atoi(argv[4]);
+        if (rank == 0) write_random_graph(filename, atol(argv[2]) * size, atol(argv[3]));
+        MPI_Barrier(MPI_COMM_WORLD);
+    }
+
+    double start = MPI_Wtime();
+    distributed::Distributed_Matrix *M = distributed::load_graph(filename.c_str());
+    double load = MPI_Wtime() - start;
+
+    // Same starting vector for both solvers
+    std::vector<double> *initial = parallel::gen_random_vector(M->n, 42);
+    parallel::Page_Rank_Options options;
+    options.initial = initial;
+
+    int iterations;
+    options.iterations = &iterations;
+    MPI_Barrier(MPI_COMM_WORLD);
+    start = MPI_Wtime();
+    std::vector<double> *ranks = distributed::Page_Rank(M, cores, options);
+    double distributed_time = (MPI_Wtime() - start) / iterations;
+
+    if (rank == 0) {
+        parallel::CSR_Matrix *S = parallel::load_graph_CSR(filename.c_str(), size * cores);
+
+        int shared_iterations;
+        options.iterations = &shared_iterations;
+        start = MPI_Wtime();
+        std::vector<double> *expected = parallel::Page_Rank(S, size * cores, options);
+        double shared_time = (MPI_Wtime() - start) / shared_iterations;
+
+        double distance = 0;
+        for (long i = 0; i < M->n; i++) {
+            distance += std::abs((*ranks)[i] - (*expected)[i]);
+        }
+
+        std::cout << "mode,processes,threads_per_process,n,NNZ,load_s,iterations,distributed_ms_per_iteration,"
+                  << "shared_memory_ms_per_iteration,L1_distance" << std::endl;
+        std::cout << argv[1] << "," << size << "," << cores << "," << M->n << "," << M->NNZ << "," << load << ","
+                  << iterations << "," << distributed_time * 1e3 << "," << shared_time * 1e3 << "," << distance << std::endl;
+
+        delete expected;
+        delete S;
+        if (weak) std::remove(filename.c_str());
+    }
+
+    delete initial;
+    delete ranks;
+    delete M;
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <chrono>
+#include <cmath>
+
+#include "../src/par_numa_page_rank.cpp"
+
+// Prints the NUMA topology and compares the time per iteration of the current layout (partitions and rank vectors
+// placed wherever the unpinned threads first touched them) with pinned threads and node-local partitions and rank
+// vectors.
+// g++ numa_benchmark.cpp -O3 -fopenmp -o numa_benchmark.exe
+
+
+/**
+ * @brief Prints the node of the first page of the in-edges of every partition.
+ */
+void print_partition_nodes(const std::vector<parallel::CSC_Matrix*> &matrices) {
+    std::cout << "Partition pages:";
+    for (size_t c = 0; c < matrices.size(); c++) {
+        const std::vector<long> &edges = matrices[c]->ROW_INDEX;
+        std::cout << " " << c << "->node" << (edges.empty() ? -1 : numa::node_of_page(edges.data()));
+    }
+    std::cout << std::endl;
+}
+
+
+/**
+ * @brief Loads the partitions and times the given solver, returning the ms per iteration.
+ */
+template <typename Solver>
+double run(const char *filename, int cores, int runs, const std::vector<double> &initial, Solver solver,
+           std::vector<double> *&ranks) {
+    std::vector<parallel::CSC_Matrix*> matrices = parallel::load_graph_CSC(filename, cores);
+    print_partition_nodes(matrices);
+
+    parallel::Page_Rank_Options options;
+    options.initial = &initial;
+    int iterations;
+    options.iterations = &iterations;
+
+    double best = INFINITY;
+    for (int i = 0; i < runs; i++) {
+        delete ranks;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        ranks = solver(matrices, cores, options);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        std::chrono::duration<double> elapsed = end - start;
+        best = std::min(best, elapsed.count() / iterations * 1e3);
+    }
+
+    for (parallel::CSC_Matrix *M : matrices) delete M;
+    return best;
+}
+
+
+int main(int argc, char *argv[]) {
+    if (argc != 3 && argc != 4) {
+        std::cout << "Usage: " << argv[0] << " <graph_file> <num_threads> [runs]" << std::endl;
+        return 1;
+    }
+
+    const char *filename = argv[1];
+    const int cores = atoi(argv[2]);
+    const int runs = argc == 4 ? atoi(argv[3]) : 5;
+
+    std::cout << "Current layout" << std::endl;
+    numa::print_topology(cores);
+
+    // The size of the graph is only known after loading it, so the starting vector is built from a first load
+    std::vector<parallel::CSC_Matrix*> probe = parallel::load_graph_CSC(filename, 1);
+    std::vector<double> *initial = parallel::gen_random_vector(probe[0]->n, 42);
+    delete probe[0];
+
+    std::vector<double> *baseline = nullptr, *local = nullptr;
+    double baseline_ms = run(filename, cores, runs, *initial, [](std::vector<parallel::CSC_Matrix*> &M, int c, parallel::Page_Rank_Options o) {
+        return parallel::Page_Rank(M, c, o);
+    }, baseline);
+
+    std::cout << std::endl << "Pinned threads, node-local partitions and rank vectors" << std::endl;
+    numa::pin_threads(cores);
+    numa::print_topology(cores);
+
+    double local_ms = run(filename, cores, runs, *initial, [](std::vector<parallel::CSC_Matrix*> &M, int c, parallel::Page_Rank_Options o) {
+        return parallel::Page_Rank_NUMA(M, c, o);
+    }, local);
+
+    double distance = 0;
+    for (size_t i = 0; i < baseline->size(); i++) {
+        distance += std::abs((*baseline)[i] - (*local)[i]);
+    }
+
+    std::cout << std::endl;
+    std::cout << "current layout: " << baseline_ms << " ms per iteration" << std::endl;
+    std::cout << "NUMA-aware:     " << local_ms << " ms per iteration" << std::endl;
+    std::cout << "speedup: " << baseline_ms / local_ms << ", L1 distance " << distance << std::endl;
+
+    delete initial;
+    delete baseline;
+    delete local;
+    return distance < 1e-12 ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstdlib>
+#include <chrono>
+#include <cmath>
+
+#include "../src/out_of_core_page_rank.cpp"
+
+// Splits a graph into shards under a memory budget, solves it out of core and compares the ranks with the in-memory
+// power method, on the given graph and on a graph whose header declares nodes with no edges after the last id used.
+// g++ out_of_core_test.cpp -O3 -fopenmp -o out_of_core_test.exe
+
+
+/**
+ * @brief Shards and solves a graph out of core, and compares the ranks with the in-memory solve.
+ */
+bool check(const char *filename, const std::string &dir, long budget, int cores) {
+    auto start = std::chrono::high_resolution_clock::now();
+    shards::Sharded_Graph G = shards::build(filename, dir, budget);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+
+    long largest = 0;
+    for (long k = 0; k < G.num_shards(); k++) {
+        shards::Shard S;
+        shards::read_shard(G, k, S);
+        largest = std::max(largest, shards::shard_bytes(S.rows, S.edges));
+    }
+
+    std::cout << "n = " << G.n << ", NNZ = " << G.NNZ << ", " << G.num_shards() << " shards built in "
+              << elapsed.count() << " s" << std::endl;
+    std::cout << "resident: " << (shards::RESIDENT_VECTORS * G.n * sizeof(double) + 2 * largest) / 1024
+              << " KB of a budget of " << budget / 1024 << " KB" << std::endl;
+
+    // Same starting vector for both solves
+    std::vector<double> *initial = parallel::gen_random_vector(G.n, 42);
+    parallel::Page_Rank_Options options;
+    options.initial = initial;
+
+    int iterations;
+    options.iterations = &iterations;
+    start = std::chrono::high_resolution_clock::now();
+    std::vector<double> *ranks = parallel::Page_Rank_Out_Of_Core(shards::open(dir), cores, options);
+    end = std::chrono::high_resolution_clock::now();
+    elapsed = end - start;
+
+    std::cout << "out of core: " << iterations << " iterations, " << elapsed.count() / iterations * 1e3
+              << " ms per iteration" << std::endl;
+
+    parallel::CSR_Matrix *M = parallel::load_graph_CSR(filename, cores);
+    if (M->n != G.n) {
+        std::cout << "The shards have " << G.n << " nodes, the graph " << M->n << std::endl;
+        return false;
+    }
+    std::vector<double> *expected = parallel::Page_Rank(M, cores, options);
+
+    double distance = 0;
+    for (long i = 0; i < G.n; i++) {
+        distance += std::abs((*ranks)[i] - (*expected)[i]);
+    }
+    std::cout << "in memory: " << iterations << " iterations, L1 distance " << distance << std::endl;
+
+    bool ok = distance <= 1e-9;
+
+    delete initial;
+    delete ranks;
+    delete expected;
+    delete M;
+    return ok;
+}
+
+
+int main(int argc, char *argv[]) {
+    if (argc != 5) {
+        std::cout << "Usage: " << argv[0] << " <graph_file> <shard_dir> <memory_budget_MB> <num_threads>" << std::endl;
+        return 1;
+    }
+
+    const char *filename = argv[1];
+    const std::string dir = argv[2];
+    const long budget = atof(argv[3]) * (1 << 20);
+    const int cores = atoi(argv[4]);
+
+    bool ok = check(filename, dir, budget, cores);
+
+    // The header declares 8 nodes, but only the nodes 0 to 3 have edges
+    std::string isolated = dir + "/isolated_tail.txt";
+    std::ofstream file(isolated);
+    file << "# Nodes: 8 Edges: 5\n0\t1\n1\t2\n2\t0\n2\t3\n3\t0\n";
+    file.close();
+
+    std::cout << std::endl << "Graph with isolated nodes after the last edge" << std::endl;
+    ok &= check(isolated.c_str(), dir, budget, cores);
+    std::remove(isolated.c_str());
+
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
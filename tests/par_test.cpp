@@ -10,30 +10,48 @@
 
 #include "../src/par_page_rank.cpp"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 
 int main(int argc, char *argv[]) {
-    if (argc != 3) {
-        std::cout << "Usage: " << argv[0] << " <graph_file> <num_threads>" << std::endl;
+    if (argc != 3 && argc != 4) {
+        std::cout << "Usage: " << argv[0] << " <graph_file> <num_threads> [csc|csr]" << std::endl;
         return 1;
     }
 
     const char *filename = argv[1];
     const int cores = atoi(argv[2]);
+    const bool csr = argc == 4 && std::string(argv[3]) == "csr";
+
+    // Load the graph, either split in one CSC partition per core or as a single shared CSR matrix
+    std::vector<parallel::CSC_Matrix*> matrices;
+    parallel::CSR_Matrix *T = nullptr;
+    long n;
+
+    if (csr) {
+        T = parallel::load_graph_CSR(filename, cores);
+        n = T->n;
 
-    // Load the graph
-    std::vector<parallel::CSC_Matrix*> matrices = parallel::load_graph_CSC(filename, cores);
-    
-    // Print the matrix
-    std::cout << "Matrix info:" << std::endl;
-    (*matrices[0]).print();
-    (*matrices[0]).print_info();
-    std::cout << std::endl;
+        std::cout << "Matrix info:" << std::endl;
+        T->print_info();
+    } else {
+        matrices = parallel::load_graph_CSC(filename, cores);
+        n = matrices[0]->n;
+
+        // Print the matrix
+        std::cout << "Matrix info:" << std::endl;
+        (*matrices[0]).print();
+        (*matrices[0]).print_info();
+        parallel::print_partition_info(matrices);
+    }
 
 
     // Run the Page Rank algorithm
     std::cout << "Running Page Rank" << std::endl;
     auto start = std::chrono::high_resolution_clock::now();
-    std::vector<double> *result = Page_Rank(matrices, cores);
+    std::vector<double> *result = csr ? parallel::Page_Rank(T, cores) : parallel::Page_Rank(matrices, cores);
     auto end = std::chrono::high_resolution_clock::now();
     std::cout << "Page Rank completed" << std::endl;
 
@@ -47,13 +65,46 @@ int main(int argc, char *argv[]) {
 
     // Verify if it's still normalized 
     double sum = 0;
-    for (long i = 0; i < matrices[0]->n; i++) {
+    for (long i = 0; i < n; i++) {
         sum += (*result)[i];
     }
     std::cout << "Sum: " << sum << std::endl;
 
     std::chrono::duration<double> elapsed = end - start;
-    std::cout << "Time: " << elapsed.count() << " s" << std::endl;
+    std::cout << "Time: " << elapsed.count() << " s" << std::endl << std::endl;
+
+
+    // Run again from the same vector in a team smaller than the number of cores: nested in an active parallel
+    // region, the solver gets a single thread, as under a thread limit, and must still compute every row
+#ifdef _OPENMP
+    omp_set_max_active_levels(1);
+#endif
+    parallel::Page_Rank_Options options;
+    std::vector<double> *initial = parallel::gen_random_vector(n, 42);
+    options.initial = initial;
+
+    std::vector<double> *full = csr ? parallel::Page_Rank(T, cores, options) : parallel::Page_Rank(matrices, cores, options);
+    std::vector<double> *reduced = nullptr;
+    #pragma omp parallel num_threads(2)
+    {
+        #pragma omp single
+        reduced = csr ? parallel::Page_Rank(T, cores, options) : parallel::Page_Rank(matrices, cores, options);
+    }
+
+    double distance = 0;
+    for (long i = 0; i < n; i++) {
+        distance += std::abs((*full)[i] - (*reduced)[i]);
+    }
+    std::cout << "Reduced team: L1 distance " << distance << " from the full team" << std::endl;
+
+    const bool ok = distance < 1e-12;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
 
-    return 0;
+    delete initial;
+    delete full;
+    delete reduced;
+    delete result;
+    delete T;
+    for (parallel::CSC_Matrix *M : matrices) delete M;
+    return ok ? 0 : 1;
 }
@@ -0,0 +1,106 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <chrono>
+#include <cmath>
+
+#include "../src/par_page_rank.cpp"
+
+// Compares the scaling, from 1 to the given number of threads, of the power method with a parallel region per
+// iteration and with a single persistent region, on the transposed matrix and on the partitions.
+// g++ persistent_scaling_benchmark.cpp -O3 -fopenmp -o persistent_scaling_benchmark.exe
+
+
+/**
+ * @brief Runs the given solver several times and returns the best time per iteration in ms.
+ */
+template <typename Solver>
+double time_per_iteration(int runs, const std::vector<double> &initial, Solver solver, std::vector<double> *&ranks) {
+    parallel::Page_Rank_Options options;
+    options.initial = &initial;
+    int iterations;
+    options.iterations = &iterations;
+
+    double best = INFINITY;
+    for (int i = 0; i < runs; i++) {
+        delete ranks;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        ranks = solver(options);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        std::chrono::duration<double> elapsed = end - start;
+        best = std::min(best, elapsed.count() / iterations * 1e3);
+    }
+
+    return best;
+}
+
+
+int main(int argc, char *argv[]) {
+    if (argc != 3 && argc != 4) {
+        std::cout << "Usage: " << argv[0] << " <graph_file> <max_threads> [runs]" << std::endl;
+        return 1;
+    }
+
+    const char *filename = argv[1];
+    const int max_cores = atoi(argv[2]);
+    const int runs = argc == 4 ? atoi(argv[3]) : 5;
+
+    parallel::CSR_Matrix *M = parallel::load_graph_CSR(filename, max_cores);
+    std::vector<double> *initial = parallel::gen_random_vector(M->n, 42);
+    std::cout << std::endl;
+
+    double fork_join_base = 0, persistent_base = 0, partitioned_fork_join_base = 0, partitioned_persistent_base = 0;
+    bool same = true;
+
+    std::cout << "threads,fork_join_ms,persistent_ms,fork_join_efficiency,persistent_efficiency,"
+              << "partitioned_fork_join_ms,partitioned_persistent_ms,partitioned_fork_join_efficiency,"
+              << "partitioned_persistent_efficiency" << std::endl;
+    for (int cores = 1; cores <= max_cores; cores++) {
+        std::vector<double> *a = nullptr, *b = nullptr, *c = nullptr, *d = nullptr;
+        std::vector<parallel::CSC_Matrix*> matrices = parallel::load_graph_CSC(filename, cores);
+
+        double fork_join = time_per_iteration(runs, *initial, [&](parallel::Page_Rank_Options o) {
+            return parallel::Page_Rank_Fork_Join(M, cores, o);
+        }, a);
+        double persistent = time_per_iteration(runs, *initial, [&](parallel::Page_Rank_Options o) {
+            return parallel::Page_Rank_Persistent(M, cores, o);
+        }, b);
+        double partitioned_fork_join = time_per_iteration(runs, *initial, [&](parallel::Page_Rank_Options o) {
+            return parallel::Page_Rank_Fork_Join(matrices, cores, o);
+        }, c);
+        double partitioned_persistent = time_per_iteration(runs, *initial, [&](parallel::Page_Rank_Options o) {
+            return parallel::Page_Rank(matrices, cores, o);
+        }, d);
+
+        if (cores == 1) {
+            fork_join_base = fork_join;
+            persistent_base = persistent;
+            partitioned_fork_join_base = partitioned_fork_join;
+            partitioned_persistent_base = partitioned_persistent;
+        }
+
+        // Parallel efficiency: the speedup over one thread divided by the number of threads
+        std::cout << cores << "," << fork_join << "," << persistent << "," << fork_join_base / fork_join / cores << ","
+                  << persistent_base / persistent / cores << "," << partitioned_fork_join << "," << partitioned_persistent
+                  << "," << partitioned_fork_join_base / partitioned_fork_join / cores << ","
+                  << partitioned_persistent_base / partitioned_persistent / cores << std::endl;
+
+        for (long i = 0; i < M->n; i++) {
+            same = same && std::abs((*a)[i] - (*b)[i]) < 1e-15 && std::abs((*c)[i] - (*d)[i]) < 1e-15;
+        }
+
+        delete a;
+        delete b;
+        delete c;
+        delete d;
+        for (parallel::CSC_Matrix *P : matrices) delete P;
+    }
+
+    std::cout << (same ? "OK" : "FAILED: the fork-join and persistent solvers give different ranks") << std::endl;
+
+    delete initial;
+    delete M;
+    return same ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <chrono>
+#include <cmath>
+
+#include "../src/par_personalized_page_rank.cpp"
+
+// Compares k personalized Page Ranks computed one at a time with the same k computed in a single batch.
+// g++ personalized_benchmark.cpp -O3 -fopenmp -o personalized_benchmark.exe
+
+
+int main(int argc, char *argv[]) {
+    if (argc != 4) {
+        std::cout << "Usage: " << argv[0] << " <graph_file> <num_threads> <num_seeds>" << std::endl;
+        return 1;
+    }
+
+    const char *filename = argv[1];
+    const int cores = atoi(argv[2]);
+    const int k = atoi(argv[3]);
+
+    parallel::CSR_Matrix *M = parallel::load_graph_CSR(filename, cores);
+
+    // Every teleport vector is a single seed, and the damping factors vary a little across the batch
+    srand(42);
+    std::vector<std::vector<double>> teleports;
+    std::vector<double> damping;
+    for (int q = 0; q < k; q++) {
+        teleports.push_back(parallel::teleport_from_seeds(M->n, {rand() % M->n}));
+        damping.push_back(0.80 + 0.10 * q / std::max(1, k - 1));
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::vector<double>> single(k);
+    for (int q = 0; q < k; q++) {
+        std::vector<std::vector<double>> *r = parallel::Personalized_Page_Rank_Batch(M, {teleports[q]}, cores, {damping[q]});
+        single[q] = (*r)[0];
+        delete r;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed_single = end - start;
+
+    int iterations = 0;
+    parallel::Page_Rank_Options options;
+    options.iterations = &iterations;
+
+    start = std::chrono::high_resolution_clock::now();
+    std::vector<std::vector<double>> *batch = parallel::Personalized_Page_Rank_Batch(M, teleports, cores, damping, options);
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed_batch = end - start;
+
+    double max_diff = 0, max_sum_error = 0;
+    for (int q = 0; q < k; q++) {
+        double sum = 0;
+        for (long r = 0; r < M->n; r++) {
+            max_diff = std::max(max_diff, std::abs((*batch)[q][r] - single[q][r]));
+            sum += (*batch)[q][r];
+        }
+        max_sum_error = std::max(max_sum_error, std::abs(sum - 1));
+    }
+
+    std::cout << "One at a time: " << elapsed_single.count() << " s" << std::endl;
+    std::cout << "Batch: " << elapsed_batch.count() << " s, " << iterations << " iterations" << std::endl;
+    std::cout << "Max difference: " << max_diff << std::endl;
+    std::cout << "Max error of the sums: " << max_sum_error << std::endl;
+
+    delete batch;
+    return 0;
+}
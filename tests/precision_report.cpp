@@ -0,0 +1,72 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <chrono>
+#include <cmath>
+
+#include "../src/par_typed_page_rank.cpp"
+
+// Reports the bytes moved per iteration and the accuracy of the compact index and precision modes against the
+// 64-bit index, double precision baseline.
+// g++ precision_report.cpp -O3 -fopenmp -o precision_report.exe
+
+
+int main(int argc, char *argv[]) {
+    if (argc != 3 && argc != 4) {
+        std::cout << "Usage: " << argv[0] << " <graph_file> <num_threads> [tolerance]" << std::endl;
+        return 1;
+    }
+
+    const char *filename = argv[1];
+    const int cores = atoi(argv[2]);
+    const double tolerance = argc == 4 ? atof(argv[3]) : 1e-6;
+
+    // Baseline: 64-bit indexes and double precision; the compact modes use the narrowest indexes that fit
+    parallel::Compact_Graph *wide = parallel::load_graph_compact(filename, cores, 64);
+    parallel::Compact_Graph *G = parallel::load_graph_compact(filename, cores);
+    std::cout << std::endl;
+
+    parallel::Page_Rank_Options options;
+    options.tolerance = tolerance;
+
+    int baseline_iterations;
+    options.iterations = &baseline_iterations;
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<double> *baseline = parallel::Page_Rank_Typed<double, double>(wide->wide, cores, options);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+    options.iterations = nullptr;
+
+    std::cout << "baseline (64-bit, double): " << parallel::bytes_per_iteration<double, uint64_t>(G->n(), G->NNZ())
+              << " bytes per iteration, " << baseline_iterations << " iterations, "
+              << elapsed.count() / baseline_iterations * 1e3 << " ms per iteration" << std::endl;
+
+    for (parallel::Precision precision : {parallel::Precision::DOUBLE, parallel::Precision::MIXED, parallel::Precision::FLOAT}) {
+        parallel::Typed_Report report;
+
+        start = std::chrono::high_resolution_clock::now();
+        std::vector<double> *ranks = parallel::Page_Rank_Compact(G, cores, precision, options, &report);
+        end = std::chrono::high_resolution_clock::now();
+        elapsed = end - start;
+
+        double distance = 0, max_relative = 0;
+        for (long i = 0; i < G->n(); i++) {
+            double d = std::abs((*ranks)[i] - (*baseline)[i]);
+            distance += d;
+            max_relative = std::max(max_relative, d / (*baseline)[i]);
+        }
+
+        std::cout << report.index_bits << "-bit, " << parallel::precision_name(precision) << ": "
+                  << report.bytes_per_iteration << " bytes per iteration, " << report.iterations << " iterations, "
+                  << elapsed.count() / report.iterations * 1e3 << " ms per iteration, "
+                  << "L1 distance " << distance << ", max relative error " << max_relative
+                  << (report.converged ? "" : ", stopped above the tolerance") << std::endl;
+
+        delete ranks;
+    }
+
+    delete baseline;
+    delete wide;
+    delete G;
+    return 0;
+}
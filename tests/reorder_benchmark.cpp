@@ -0,0 +1,103 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <chrono>
+#include <cmath>
+
+#include "../datagen/reorder.cpp"
+#include "../src/par_page_rank.cpp"
+#include "../src/seq_page_rank.cpp"
+#include "../src/perf_counter.cpp"
+
+// Compares the time and the cache misses of the Page Rank iterations with every vertex ordering.
+// g++ reorder_benchmark.cpp -O3 -fopenmp -o reorder_benchmark.exe
+
+
+int main(int argc, char *argv[]) {
+    if (argc != 3 && argc != 4) {
+        std::cout << "Usage: " << argv[0] << " <graph_file> <num_threads> [iterations]" << std::endl;
+        return 1;
+    }
+
+    const char *filename = argv[1];
+    const int cores = atoi(argv[2]);
+    const int iterations = argc == 4 ? atoi(argv[3]) : 50;
+
+    sequential::CSC_Matrix *M = sequential::load_graph_CSC(filename);
+    std::cout << std::endl;
+
+    sequential::Page_Rank_Options options;
+    options.tolerance = 1e-10;
+    std::vector<double> uniform(M->n, 1.0 / M->n);
+    options.initial = &uniform;
+    std::vector<double> *reference = sequential::Page_Rank(M, options);
+
+    perf::Counter misses;
+    if (!misses.available()) std::cout << "Cache miss counter not available" << std::endl << std::endl;
+
+    for (reorder::Ordering ordering : {reorder::Ordering::ORIGINAL, reorder::Ordering::DEGREE, reorder::Ordering::RCM, reorder::Ordering::COMMUNITY}) {
+        auto start = std::chrono::high_resolution_clock::now();
+        reorder::Permutation P = reorder::compute(M, ordering);
+        sequential::CSC_Matrix *R = reorder::apply(M, P);
+        parallel::CSR_Matrix T(R->n, R->NNZ, R->COL_PTR.data(), R->ROW_INDEX.data(), R->OUT_DEGREE.data(),
+                               R->num_null_cols, R->indexes_null_cols.data(), cores);
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> preprocessing = end - start;
+
+        long n = R->n;
+        std::vector<double> v(n, 1.0 / n), result(n, 0), contrib(n), next_contrib(n);
+        std::vector<long> bounds = parallel::balanced_row_bounds(T.ROW_PTR.data(), n, cores);
+
+        // Sequential push on the CSC matrix
+        double dangling = sequential::prepare_contrib(R, v.data(), contrib.data());
+        misses.start();
+        start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            sequential::page_rank_iter_fused(R, v.data(), result.data(), contrib.data(), dangling);
+            std::swap(v, result);
+        }
+        end = std::chrono::high_resolution_clock::now();
+        long seq_misses = misses.stop();
+        std::chrono::duration<double> seq_time = end - start;
+
+        // Parallel pull on the CSR matrix
+        std::fill(v.begin(), v.end(), 1.0 / n);
+        dangling = parallel::prepare_contrib(n, T.OUT_DEGREE.data(), v.data(), contrib.data(), cores);
+        misses.start();
+        start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            parallel::page_rank_iter_fused(&T, v.data(), result.data(), contrib.data(), next_contrib.data(), dangling, bounds, cores);
+            std::swap(v, result);
+            std::swap(contrib, next_contrib);
+        }
+        end = std::chrono::high_resolution_clock::now();
+        long par_misses = misses.stop();
+        std::chrono::duration<double> par_time = end - start;
+
+        // The ranks, mapped back to the original ids, must not depend on the ordering
+        std::vector<double> uniform(n, 1.0 / n);
+        sequential::Page_Rank_Options solve = options;
+        solve.initial = &uniform;
+        std::vector<double> *ranks = sequential::Page_Rank(R, solve);
+        std::vector<double> *original = P.to_original(*ranks);
+        double distance = 0;
+        for (long u = 0; u < n; u++) {
+            distance += std::abs((*original)[u] - (*reference)[u]);
+        }
+
+        std::cout << reorder::ordering_name(ordering) << ": preprocessing " << preprocessing.count() << " s" << std::endl;
+        std::cout << "  sequential CSC: " << seq_time.count() / iterations * 1e3 << " ms per iteration";
+        if (seq_misses >= 0) std::cout << ", " << seq_misses / iterations << " cache misses per iteration";
+        std::cout << std::endl;
+        std::cout << "  parallel CSR:   " << par_time.count() / iterations * 1e3 << " ms per iteration";
+        if (par_misses >= 0) std::cout << ", " << par_misses / iterations << " cache misses per iteration";
+        std::cout << std::endl;
+        std::cout << "  L1 distance from the original ordering: " << distance << std::endl;
+
+        delete ranks;
+        delete original;
+        delete R;
+    }
+
+    return 0;
+}
@@ -29,16 +29,30 @@ int main(int argc, char *argv[]) {
 
     const char *filename = argv[1];
 
+    // Binary snapshots are mapped in place, text edge lists are parsed
+    bool mapped = snapshot::is_snapshot(filename);
+    sequential::CSC_Matrix *M = nullptr;
+    snapshot::Mapped_CSC *S = nullptr;
+
     auto start = std::chrono::high_resolution_clock::now();
-    sequential::CSC_Matrix *M = sequential::load_graph_CSC(filename);
+    if (mapped) {
+        S = snapshot::map_graph_CSC(filename);
+    } else {
+        M = sequential::load_graph_CSC(filename);
+    }
     auto end = std::chrono::high_resolution_clock::now();
 
     std::chrono::duration<double> elapsed = end - start;
     std::cout << "Time to load the file: " << elapsed.count() << " s" << std::endl << std::endl;
-    M->print(); M->print_info(); 
+    if (mapped) {
+        S->print_info();
+    } else {
+        M->print(); M->print_info(); 
+    }
+    long n = mapped ? S->n : M->n;
 
     start = std::chrono::high_resolution_clock::now();
-    std::vector<double> *result = Page_Rank(M);
+    std::vector<double> *result = mapped ? sequential::Page_Rank(S) : sequential::Page_Rank(M);
     end = std::chrono::high_resolution_clock::now();
 
     // Print the result
@@ -50,7 +64,7 @@ int main(int argc, char *argv[]) {
 
     // Verify if it's still normalized 
     double sum = 0;
-    for (long i = 0; i < M->n; i++) {
+    for (long i = 0; i < n; i++) {
         sum += (*result)[i];
     }
     std::cout << "Sum: " << sum << std::endl;
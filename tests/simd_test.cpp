@@ -0,0 +1,76 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <chrono>
+#include <cmath>
+
+#include "../src/par_page_rank.cpp"
+
+// Checks that every kernel variant supported by the CPU gives the same ranks as the scalar one, and times them.
+// g++ simd_test.cpp -O3 -fopenmp -o simd_test.exe
+
+
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        std::cout << "Usage: " << argv[0] << " <graph_file> <num_threads>" << std::endl;
+        return 1;
+    }
+
+    const char *filename = argv[1];
+    const int cores = atoi(argv[2]);
+    const int iterations = 50;
+
+    parallel::CSR_Matrix *M = parallel::load_graph_CSR(filename, cores);
+    std::cout << std::endl << "Selected at startup: " << simd::isa_name(simd::active.isa) << std::endl;
+
+    long n = M->n;
+    std::vector<long> bounds = parallel::balanced_row_bounds(M->ROW_PTR.data(), n, cores);
+    std::vector<double> uniform(n, 1.0 / n);
+
+    parallel::Page_Rank_Options options;
+    options.tolerance = 1e-12;
+    options.initial = &uniform;
+
+    std::vector<double> *reference = nullptr;
+    bool ok = true;
+
+    for (simd::Isa isa : {simd::Isa::SCALAR, simd::Isa::AVX2, simd::Isa::AVX512}) {
+        if (!simd::supported(isa)) {
+            std::cout << simd::isa_name(isa) << ": not supported" << std::endl;
+            continue;
+        }
+        simd::set_isa(isa);
+
+        // Time of the iterations
+        std::vector<double> v(uniform), result(n), contrib(n), next_contrib(n);
+        double dangling = parallel::prepare_contrib(n, M->OUT_DEGREE.data(), v.data(), contrib.data(), cores);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            parallel::page_rank_iter_simd(M, v.data(), result.data(), contrib.data(), next_contrib.data(), dangling, bounds, cores);
+            std::swap(v, result);
+            std::swap(contrib, next_contrib);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> elapsed = end - start;
+
+        // Ranks of a full solve
+        std::vector<double> *ranks = parallel::Page_Rank(M, cores, options);
+        double distance = 0;
+        if (reference == nullptr) {
+            reference = ranks;
+        } else {
+            for (long i = 0; i < n; i++) {
+                distance += std::abs((*ranks)[i] - (*reference)[i]);
+            }
+            ok &= distance < 1e-10;
+            delete ranks;
+        }
+
+        std::cout << simd::isa_name(isa) << ": " << elapsed.count() / iterations * 1e3 << " ms per iteration, "
+                  << "L1 distance from scalar " << distance << std::endl;
+    }
+
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
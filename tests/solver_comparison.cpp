@@ -0,0 +1,87 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <chrono>
+#include <cmath>
+
+#include "../src/seq_page_rank.cpp"
+#include "../src/par_page_rank.cpp"
+
+// Compares the number of iterations and the time of the power method and of the Gauss-Seidel solvers.
+// g++ solver_comparison.cpp -O3 -fopenmp -o solver_comparison.exe
+
+
+/**
+ * @brief Runs a solver, prints its iterations and time and the L1 distance of its result from the reference.
+ */
+template <typename Solve>
+std::vector<double>* run(const char *name, std::vector<double> *reference, Solve solve) {
+    int iterations = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<double> *result = solve(&iterations);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double> elapsed = end - start;
+    std::cout << name << ": " << iterations << " iterations, " << elapsed.count() << " s";
+
+    if (reference != nullptr) {
+        double distance = 0;
+        for (size_t i = 0; i < result->size(); i++) {
+            distance += std::abs((*result)[i] - (*reference)[i]);
+        }
+        std::cout << ", L1 distance from the power method: " << distance;
+    }
+    std::cout << std::endl;
+
+    return result;
+}
+
+
+int main(int argc, char *argv[]) {
+    if (argc != 3 && argc != 4) {
+        std::cout << "Usage: " << argv[0] << " <graph_file> <num_threads> [tolerance]" << std::endl;
+        return 1;
+    }
+
+    const char *filename = argv[1];
+    const int cores = atoi(argv[2]);
+    const double tolerance = argc == 4 ? atof(argv[3]) : 1e-6;
+
+    sequential::CSC_Matrix *M = sequential::load_graph_CSC(filename);
+    sequential::CSR_Matrix T(M);
+    parallel::CSR_Matrix *P = parallel::load_graph_CSR(filename, cores);
+    std::cout << std::endl;
+
+    std::vector<double> *power = run("Sequential power", nullptr, [&](int *iterations) {
+        sequential::Page_Rank_Options options;
+        options.tolerance = tolerance;
+        options.iterations = iterations;
+        return sequential::Page_Rank(M, options);
+    });
+
+    run("Sequential Gauss-Seidel", power, [&](int *iterations) {
+        sequential::Page_Rank_Options options;
+        options.tolerance = tolerance;
+        options.iterations = iterations;
+        return sequential::Page_Rank_Gauss_Seidel(&T, options);
+    });
+
+    run("Parallel power (CSR)", power, [&](int *iterations) {
+        parallel::Page_Rank_Options options;
+        options.tolerance = tolerance;
+        options.iterations = iterations;
+        return parallel::Page_Rank(P, cores, options);
+    });
+
+    run("Parallel block Gauss-Seidel (CSR)", power, [&](int *iterations) {
+        parallel::Page_Rank_Options options;
+        options.solver = parallel::Solver::GAUSS_SEIDEL;
+        options.tolerance = tolerance;
+        options.iterations = iterations;
+        return parallel::Page_Rank(P, cores, options);
+    });
+
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <cmath>
+
+#include "../src/seq_page_rank.cpp"
+#include "../src/par_page_rank.cpp"
+
+// Solves the graph with the sequential power method and with the parallel one on the transposed matrix and on the
+// partitions, prints the progress of every iteration from the callback, and writes the traces of the solves as JSON
+// or CSV.
+// g++ telemetry_report.cpp -O3 -fopenmp -o telemetry_report.exe
+
+
+/**
+ * @brief Prints the statistics of an iteration on a single line.
+ */
+void print_progress(const telemetry::Iteration_Stats &s) {
+    std::cout << "  iteration " << s.iteration << ": residual " << s.residual << ", " << s.seconds * 1e3 << " ms (spmv "
+              << s.spmv_seconds * 1e3 << ", finalize " << s.finalize_seconds * 1e3 << ", sync " << s.sync_seconds * 1e3
+              << "), " << s.edges_per_second * 1e-6 << " Medges/s, " << s.gb_per_second << " GB/s" << std::endl;
+}
+
+
+/**
+ * @brief Checks that the trace has one entry per iteration, that no iteration is shorter than its phases, and that
+ * the ranks sum to one.
+ */
+bool consistent(const telemetry::Page_Rank_Result &r) {
+    double sum = 0;
+    for (double x : r.ranks) sum += x;
+
+    bool ok = (int)r.trace.iterations.size() == r.iterations && !r.trace.iterations.empty() &&
+              r.trace.iterations.back().iteration == r.iterations && std::abs(sum - 1) < 1e-9;
+    for (const telemetry::Iteration_Stats &s : r.trace.iterations) {
+        // The phases are differences of the same clock reads, so they add up to the wall time up to rounding
+        double phases = s.spmv_seconds + s.finalize_seconds;
+        ok &= phases <= s.seconds * (1 + 1e-9) && s.sync_seconds >= -1e-9 * s.seconds;
+    }
+    if (!ok) std::cout << "FAILED: inconsistent trace for " << r.trace.solver << std::endl;
+    return ok;
+}
+
+
+int main(int argc, char *argv[]) {
+    if (argc != 5 && argc != 6) {
+        std::cout << "Usage: " << argv[0] << " <graph_file> <num_threads> <json|csv> <output_file> [tolerance]" << std::endl;
+        return 1;
+    }
+
+    const char *filename = argv[1];
+    const int cores = atoi(argv[2]);
+    const std::string format = argv[3];
+    const char *output = argv[4];
+
+    if (format != "json" && format != "csv") {
+        std::cout << "Unknown format: " << format << std::endl;
+        return 1;
+    }
+
+    sequential::CSC_Matrix *M = sequential::load_graph_CSC(filename);
+    parallel::CSR_Matrix *T = parallel::load_graph_CSR(filename, cores);
+    std::vector<parallel::CSC_Matrix*> partitions = parallel::load_graph_CSC(filename, cores);
+    std::vector<double> *initial = sequential::gen_random_vector(M->n, 42);
+    std::cout << std::endl;
+
+    sequential::Page_Rank_Options seq_options;
+    seq_options.initial = initial;
+    parallel::Page_Rank_Options par_options;
+    par_options.initial = initial;
+    if (argc == 6) seq_options.tolerance = par_options.tolerance = atof(argv[5]);
+
+    std::cout << "sequential power method" << std::endl;
+    telemetry::Page_Rank_Result seq = sequential::Page_Rank_Traced(M, seq_options, print_progress);
+    std::cout << "parallel power method, " << cores << " threads" << std::endl;
+    telemetry::Page_Rank_Result par = parallel::Page_Rank_Traced(T, cores, par_options, print_progress);
+    std::cout << "parallel power method on the partitions, " << cores << " threads" << std::endl;
+    telemetry::Page_Rank_Result part = parallel::Page_Rank_Traced(partitions, cores, par_options, print_progress);
+
+    std::ofstream out(output);
+    if (!out.is_open()) {
+        std::cout << "Unable to open file" << std::endl;
+        return 1;
+    }
+
+    if (format == "json") {
+        out << "[";
+        telemetry::write_json(out, seq);
+        out << ",";
+        telemetry::write_json(out, par);
+        out << ",";
+        telemetry::write_json(out, part);
+        out << "]" << std::endl;
+    } else {
+        telemetry::write_csv(out, seq);
+        telemetry::write_csv(out, par, false);
+        telemetry::write_csv(out, part, false);
+    }
+    out.close();
+
+    std::cout << "Trace written to " << output << std::endl;
+    bool ok = consistent(seq) && consistent(par) && consistent(part);
+
+    delete initial;
+    delete M;
+    delete T;
+    for (parallel::CSC_Matrix *P : partitions) delete P;
+    return ok ? 0 : 1;
+}